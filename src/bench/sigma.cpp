@@ -0,0 +1,111 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <sigma/coin.h>
+#include <sigma/coinspend.h>
+#include <streams.h>
+#include <version.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+static const int SIGMA_ANONYMITY_SET_SIZE = 1024;
+static const int SIGMA_SPENDS_PER_BLOCK = 16;
+
+// Builds an anonymity set together with a number of spends made against it,
+// as seen by a node connecting a block full of sigma spends.
+static void CreateSigmaSpends(
+    const sigma::Params* params,
+    std::vector<sigma::PublicCoin>& anonymity_set,
+    std::vector<std::unique_ptr<sigma::CoinSpend>>& spends,
+    std::vector<sigma::SpendMetaData>& metadata)
+{
+    std::vector<sigma::PrivateCoin> privateCoins;
+    for (int i = 0; i < SIGMA_ANONYMITY_SET_SIZE; ++i) {
+        sigma::PrivateCoin coin(params, sigma::CoinDenomination::SIGMA_1, sigma::SIGMA_VERSION_2);
+        anonymity_set.push_back(coin.getPublicCoin());
+        if (i < SIGMA_SPENDS_PER_BLOCK)
+            privateCoins.push_back(coin);
+    }
+
+    uint256 blockHash;
+    blockHash.SetHex("1");
+    for (const sigma::PrivateCoin& coin : privateCoins) {
+        uint256 txHash = GetRandHash();
+        sigma::SpendMetaData m(1, blockHash, txHash);
+        spends.emplace_back(new sigma::CoinSpend(params, coin, anonymity_set, m, true));
+        spends.back()->setVersion(sigma::SIGMA_VERSION_2);
+        metadata.push_back(m);
+    }
+}
+
+static void SigmaVerifyEach(benchmark::State& state)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    std::vector<sigma::PublicCoin> anonymity_set;
+    std::vector<std::unique_ptr<sigma::CoinSpend>> spends;
+    std::vector<sigma::SpendMetaData> metadata;
+    CreateSigmaSpends(params, anonymity_set, spends, metadata);
+
+    while (state.KeepRunning()) {
+        for (std::size_t i = 0; i < spends.size(); ++i)
+            assert(spends[i]->Verify(anonymity_set, metadata[i], true));
+    }
+}
+
+static void SigmaVerifyBatch(benchmark::State& state)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    std::vector<sigma::PublicCoin> anonymity_set;
+    std::vector<std::unique_ptr<sigma::CoinSpend>> spends;
+    std::vector<sigma::SpendMetaData> metadata;
+    CreateSigmaSpends(params, anonymity_set, spends, metadata);
+
+    std::vector<const sigma::CoinSpend*> batch;
+    for (const auto& spend : spends)
+        batch.push_back(spend.get());
+    std::vector<bool> fPadding(batch.size(), true);
+
+    while (state.KeepRunning()) {
+        assert(sigma::CoinSpend::BatchVerify(params, anonymity_set, batch, metadata, fPadding));
+    }
+}
+
+static void SigmaMint(benchmark::State& state)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+
+    while (state.KeepRunning()) {
+        sigma::PrivateCoin coin(params, sigma::CoinDenomination::SIGMA_1, sigma::SIGMA_VERSION_2);
+        assert(coin.getPublicCoin().validate());
+    }
+}
+
+// Reads back the mints of a block index entry, as done for every block when
+// the block index is loaded.
+static void SigmaLoadMints(benchmark::State& state)
+{
+    const sigma::Params* params = sigma::Params::get_default();
+    std::vector<sigma::PublicCoin> mints;
+    for (int i = 0; i < SIGMA_SPENDS_PER_BLOCK; ++i)
+        mints.push_back(sigma::PrivateCoin(params, sigma::CoinDenomination::SIGMA_1, sigma::SIGMA_VERSION_2).getPublicCoin());
+
+    CDataStream stream(SER_DISK, PROTOCOL_VERSION);
+    stream << mints;
+
+    while (state.KeepRunning()) {
+        CDataStream ss(stream);
+        std::vector<sigma::PublicCoin> loaded;
+        ss >> loaded;
+        assert(loaded.size() == mints.size());
+    }
+}
+
+BENCHMARK(SigmaVerifyEach, 2);
+BENCHMARK(SigmaVerifyBatch, 2);
+BENCHMARK(SigmaMint, 1000);
+BENCHMARK(SigmaLoadMints, 20000);
@@ -0,0 +1,179 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <netbase.h>
+#include <random.h>
+#include <util.h>
+
+#ifndef WIN32
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+// Mostly idle peers, a few of which send something between wakeups, which is
+// what the socket handler of a well connected ghostnode or seed sees.
+static const int SELECT_PEERS = 400;
+static const int EPOLL_PEERS = 4000;
+static const int ACTIVE_PEERS_PER_WAKEUP = 8;
+
+// A set of connected loopback TCP peers. vRemote are the sockets a node would
+// service, vLocal are the ends used to send them data.
+struct LoopbackPeers
+{
+    std::vector<SOCKET> vLocal;
+    std::vector<SOCKET> vRemote;
+
+    explicit LoopbackPeers(int nPeers)
+    {
+        RaiseFileDescriptorLimit(2 * nPeers + 64);
+
+        SOCKET hListen = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        assert(hListen != INVALID_SOCKET);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        assert(bind(hListen, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        assert(getsockname(hListen, (struct sockaddr*)&addr, &len) == 0);
+        assert(listen(hListen, SOMAXCONN) == 0);
+
+        // Stop early rather than fail if the descriptor limit can't be raised
+        for (int i = 0; i < nPeers; i++) {
+            SOCKET hLocal = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (hLocal == INVALID_SOCKET)
+                break;
+            if (connect(hLocal, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+                close(hLocal);
+                break;
+            }
+            SOCKET hRemote = accept(hListen, nullptr, nullptr);
+            if (hRemote == INVALID_SOCKET) {
+                close(hLocal);
+                break;
+            }
+            SetSocketNonBlocking(hRemote, true);
+            vLocal.push_back(hLocal);
+            vRemote.push_back(hRemote);
+        }
+        close(hListen);
+    }
+
+    ~LoopbackPeers()
+    {
+        for (SOCKET hSocket : vLocal)
+            close(hSocket);
+        for (SOCKET hSocket : vRemote)
+            close(hSocket);
+    }
+
+    // Have a few random peers send a byte, returning how many did
+    int Wake(FastRandomContext& rng)
+    {
+        int nSent = 0;
+        for (int i = 0; i < ACTIVE_PEERS_PER_WAKEUP; i++) {
+            char ch = 0;
+            if (send(vLocal[rng.randrange(vLocal.size())], &ch, 1, 0) == 1)
+                nSent++;
+        }
+        return nSent;
+    }
+
+    // Read everything pending on a peer socket, returning the byte count
+    static int Drain(SOCKET hSocket)
+    {
+        char pchBuf[256];
+        int nTotal = 0;
+        ssize_t nBytes;
+        while ((nBytes = recv(hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT)) > 0)
+            nTotal += nBytes;
+        return nTotal;
+    }
+};
+
+// Rebuilds the fd_set over every peer for each wakeup, as the select()
+// backend of CConnman::ThreadSocketHandler does.
+static void SocketEventsSelect(benchmark::State& state)
+{
+    LoopbackPeers peers(SELECT_PEERS);
+    assert(!peers.vRemote.empty());
+    FastRandomContext rng(true);
+
+    while (state.KeepRunning()) {
+        int nPending = peers.Wake(rng);
+        while (nPending > 0) {
+            fd_set fdsetRecv;
+            FD_ZERO(&fdsetRecv);
+            SOCKET hSocketMax = 0;
+            for (SOCKET hSocket : peers.vRemote) {
+                if (hSocket >= FD_SETSIZE)
+                    continue;
+                FD_SET(hSocket, &fdsetRecv);
+                hSocketMax = std::max(hSocketMax, hSocket);
+            }
+            struct timeval timeout = {1, 0};
+            if (select(hSocketMax + 1, &fdsetRecv, nullptr, nullptr, &timeout) <= 0)
+                break;
+            for (SOCKET hSocket : peers.vRemote) {
+                if (hSocket < FD_SETSIZE && FD_ISSET(hSocket, &fdsetRecv))
+                    nPending -= LoopbackPeers::Drain(hSocket);
+            }
+        }
+    }
+}
+
+#ifdef USE_EPOLL
+// Registers every peer once with EPOLLET and only touches the sockets the
+// kernel reports, as the epoll backend does.
+static void SocketEventsEpoll(benchmark::State& state, int nPeers)
+{
+    LoopbackPeers peers(nPeers);
+    assert(!peers.vRemote.empty());
+    FastRandomContext rng(true);
+
+    int epollfd = epoll_create1(EPOLL_CLOEXEC);
+    assert(epollfd != -1);
+    for (SOCKET hSocket : peers.vRemote) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.fd = hSocket;
+        assert(epoll_ctl(epollfd, EPOLL_CTL_ADD, hSocket, &event) == 0);
+    }
+
+    struct epoll_event events[512];
+    while (state.KeepRunning()) {
+        int nPending = peers.Wake(rng);
+        while (nPending > 0) {
+            int nEvents = epoll_wait(epollfd, events, 512, 1000);
+            if (nEvents <= 0)
+                break;
+            for (int i = 0; i < nEvents; i++)
+                nPending -= LoopbackPeers::Drain(events[i].data.fd);
+        }
+    }
+    close(epollfd);
+}
+
+static void SocketEventsEpollSmall(benchmark::State& state)
+{
+    SocketEventsEpoll(state, SELECT_PEERS);
+}
+
+static void SocketEventsEpollLarge(benchmark::State& state)
+{
+    SocketEventsEpoll(state, EPOLL_PEERS);
+}
+
+BENCHMARK(SocketEventsEpollSmall, 20 * 1000);
+BENCHMARK(SocketEventsEpollLarge, 20 * 1000);
+#endif
+
+BENCHMARK(SocketEventsSelect, 5 * 1000);
+#endif // WIN32
@@ -0,0 +1,97 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <executor.h>
+#include <libzerocoin/Zerocoin.h>
+#include <util.h>
+#include <zerocoin/zerocoin.h>
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+static const int ZEROCOIN_SPENDS_PER_BLOCK = 8;
+
+// Mints a number of coins into one accumulator and spends each of them, as seen
+// by a node connecting a historical block full of zerocoin spends.
+static void CreateZerocoinSpends(
+    const libzerocoin::Params* params,
+    libzerocoin::Accumulator& accumulator,
+    const libzerocoin::SpendMetaData& metaData,
+    std::vector<std::unique_ptr<libzerocoin::CoinSpend>>& spends)
+{
+    std::vector<libzerocoin::PrivateCoin> coins;
+    for (int i = 0; i < ZEROCOIN_SPENDS_PER_BLOCK; ++i) {
+        coins.emplace_back(params, libzerocoin::ZQ_ONE);
+        accumulator += coins.back().getPublicCoin();
+    }
+
+    for (int i = 0; i < ZEROCOIN_SPENDS_PER_BLOCK; ++i) {
+        libzerocoin::Accumulator others(params, libzerocoin::ZQ_ONE);
+        for (int j = 0; j < ZEROCOIN_SPENDS_PER_BLOCK; ++j) {
+            if (j != i)
+                others += coins[j].getPublicCoin();
+        }
+        libzerocoin::AccumulatorWitness witness(params, others, coins[i].getPublicCoin());
+        spends.emplace_back(new libzerocoin::CoinSpend(params, coins[i], accumulator, witness, metaData, uint256()));
+    }
+}
+
+static void ZerocoinSpendVerify(benchmark::State& state)
+{
+    libzerocoin::Accumulator accumulator(ZCParams, libzerocoin::ZQ_ONE);
+    libzerocoin::SpendMetaData metaData(1, uint256());
+    std::vector<std::unique_ptr<libzerocoin::CoinSpend>> spends;
+    CreateZerocoinSpends(ZCParams, accumulator, metaData, spends);
+
+    while (state.KeepRunning()) {
+        for (const auto& spend : spends)
+            assert(spend->Verify(accumulator, metaData));
+    }
+}
+
+// Same block checked with -zcverifyparallel, one spend per task
+static void ZerocoinSpendVerifyParallel(benchmark::State& state)
+{
+    libzerocoin::Accumulator accumulator(ZCParams, libzerocoin::ZQ_ONE);
+    libzerocoin::SpendMetaData metaData(1, uint256());
+    std::vector<std::unique_ptr<libzerocoin::CoinSpend>> spends;
+    CreateZerocoinSpends(ZCParams, accumulator, metaData, spends);
+
+    CComputeExecutor executor;
+    executor.Start(GetNumCores() - 1);
+    while (state.KeepRunning()) {
+        std::atomic<bool> fValid(true);
+        executor.ParallelFor(spends.size(), [&](size_t nBegin, size_t nEnd) {
+            for (size_t i = nBegin; i < nEnd; i++)
+                fValid = fValid && spends[i]->Verify(accumulator, metaData);
+        }, 1);
+        assert(fValid);
+    }
+}
+
+// Proves that two commitments to a coin value, one under the serial number
+// group and one under the accumulator group, open to the same value, as done
+// for every zerocoin spend.
+static void ZerocoinCommitmentPoKVerify(benchmark::State& state)
+{
+    const libzerocoin::Params* params = ZCParams;
+    const libzerocoin::IntegerGroupParams* serialGroup = &params->serialNumberSoKCommitmentGroup;
+    const libzerocoin::IntegerGroupParams* accGroup = &params->accumulatorParams.accumulatorPoKCommitmentGroup;
+
+    CBigNum value = CBigNum::randBignum(params->coinCommitmentGroup.groupOrder);
+    libzerocoin::Commitment serialCommitment(serialGroup, value);
+    libzerocoin::Commitment accCommitment(accGroup, value);
+    libzerocoin::CommitmentProofOfKnowledge pok(serialGroup, accGroup, serialCommitment, accCommitment);
+
+    while (state.KeepRunning()) {
+        assert(pok.Verify(serialCommitment.getCommitmentValue(), accCommitment.getCommitmentValue()));
+    }
+}
+
+BENCHMARK(ZerocoinSpendVerify, 1);
+BENCHMARK(ZerocoinSpendVerifyParallel, 1);
+BENCHMARK(ZerocoinCommitmentPoKVerify, 50);
@@ -16,6 +16,7 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 #include <sigma/coin.h>
+#include <memory>
 #include <unordered_set>
 
 
@@ -178,6 +179,63 @@ enum BlockStatus: uint32_t {
     BLOCK_FAILED_MASK        =   BLOCK_FAILED_VALID | BLOCK_FAILED_CHILD,
 
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
+
+    BLOCK_HAVE_GHOSTED      =   256, //!< nCycleGhostedValue is set
+};
+
+/** Zerocoin and sigma data of a block. Only a small fraction of blocks carries
+ * mints or spends, so CBlockIndex keeps this out of line and leaves it
+ * unallocated for all other blocks.
+ */
+struct CBlockIndexPrivacyData
+{
+    //! Public coin values of mints in this block, ordered by serialized value of public coin
+    //! Maps <denomination,id> to vector of public coins
+    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
+    //! Accumulator updates. Contains only changes made by mints in this block
+    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
+    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
+    //! Values of coin serials spent in this block
+    set<CBigNum> spentSerials;
+
+    map<pair<int,int>, pair<CBigNum,int>> accumulatorChangesV2;
+
+    std::map<pair<sigma::CoinDenomination, int>, vector<sigma::PublicCoin>> mintedPubCoinsV2;
+
+    unordered_set<secp_primitives::Scalar, sigma::CScalarHash> spentSerialsV2;
+
+    bool IsEmpty() const
+    {
+        return mintedPubCoins.empty() && accumulatorChanges.empty() && spentSerials.empty() &&
+            accumulatorChangesV2.empty() && mintedPubCoinsV2.empty() && spentSerialsV2.empty();
+    }
+
+    static const CBlockIndexPrivacyData& Empty()
+    {
+        static const CBlockIndexPrivacyData empty;
+        return empty;
+    }
+};
+
+/** Owning pointer to CBlockIndexPrivacyData that copies the data along with the
+ * block index entry, as done when constructing a CDiskBlockIndex.
+ */
+class CBlockIndexPrivacyDataPtr : public std::unique_ptr<CBlockIndexPrivacyData>
+{
+public:
+    CBlockIndexPrivacyDataPtr() {}
+    CBlockIndexPrivacyDataPtr(CBlockIndexPrivacyDataPtr&&) = default;
+    CBlockIndexPrivacyDataPtr& operator=(CBlockIndexPrivacyDataPtr&&) = default;
+
+    CBlockIndexPrivacyDataPtr(const CBlockIndexPrivacyDataPtr& other)
+        : std::unique_ptr<CBlockIndexPrivacyData>(other ? new CBlockIndexPrivacyData(*other) : nullptr) {}
+
+    CBlockIndexPrivacyDataPtr& operator=(const CBlockIndexPrivacyDataPtr& other)
+    {
+        if (this != &other)
+            reset(other ? new CBlockIndexPrivacyData(*other) : nullptr);
+        return *this;
+    }
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -230,6 +288,9 @@ public:
     COutPoint prevoutStake;
     CAmount nMoneySupply;
 
+    //! value added to the ghost fee pool since the start of the fee distribution cycle, including this block
+    CAmount nCycleGhostedValue;
+
     //! block header
     int32_t nVersion;
     uint256 hashMerkleRoot;
@@ -243,22 +304,8 @@ public:
     //! (memory only) Maximum nTime in the chain up to and including this block.
     unsigned int nTimeMax;
 
-    //! zerocoin specific fields
-    //!
-    //! Public coin values of mints in this block, ordered by serialized value of public coin
-    //! Maps <denomination,id> to vector of public coins
-    map<pair<int,int>, vector<CBigNum>> mintedPubCoins;
-    //! Accumulator updates. Contains only changes made by mints in this block
-    //! Maps <denomination, id> to <accumulator value (CBigNum), number of such mints in this block>
-    map<pair<int,int>, pair<CBigNum,int>> accumulatorChanges;
-    //! Values of coin serials spent in this block
-    set<CBigNum> spentSerials;
-
-    map<pair<int,int>, pair<CBigNum,int>> accumulatorChangesV2;
-
-    std::map<pair<sigma::CoinDenomination, int>, vector<sigma::PublicCoin>> mintedPubCoinsV2;
-
-    unordered_set<secp_primitives::Scalar, sigma::CScalarHash> spentSerialsV2;
+    //! zerocoin and sigma specific fields, allocated only for blocks with mints or spends
+    CBlockIndexPrivacyDataPtr privacyData;
 
     void SetNull()
     {
@@ -280,6 +327,7 @@ public:
         bnStakeModifier = uint256();
         prevoutStake.SetNull();
         nMoneySupply = 0;
+        nCycleGhostedValue = 0;
 
         nVersion       = 0;
         hashMerkleRoot = uint256();
@@ -288,13 +336,28 @@ public:
         nNonce         = 0;
 
         //Zerocoin params
-        mintedPubCoins.clear();
-        accumulatorChanges.clear();
-        spentSerials.clear();
+        privacyData.reset();
+    }
+
+    //! Zerocoin and sigma data of this block; an empty instance if the block has none
+    const CBlockIndexPrivacyData& GetPrivacyData() const
+    {
+        return privacyData ? *privacyData : CBlockIndexPrivacyData::Empty();
+    }
 
-        mintedPubCoinsV2.clear();
-        spentSerialsV2.clear();
-        accumulatorChangesV2.clear();
+    //! Zerocoin and sigma data of this block for modification, allocated on first use
+    CBlockIndexPrivacyData& PrivacyData()
+    {
+        if (!privacyData)
+            privacyData.reset(new CBlockIndexPrivacyData());
+        return *privacyData;
+    }
+
+    //! Release the zerocoin and sigma data again if the block turned out to have none
+    void CompactPrivacyData()
+    {
+        if (privacyData && privacyData->IsEmpty())
+            privacyData.reset();
     }
 
     CBlockIndex()
@@ -498,9 +561,11 @@ public:
         READWRITE(nNonce);
 
         //Zerocoin params
-        READWRITE(mintedPubCoins);
-        READWRITE(accumulatorChanges);
-        READWRITE(spentSerials);
+        CBlockIndexPrivacyData empty;
+        CBlockIndexPrivacyData& privacy = (ser_action.ForRead() || privacyData) ? PrivacyData() : empty;
+        READWRITE(privacy.mintedPubCoins);
+        READWRITE(privacy.accumulatorChanges);
+        READWRITE(privacy.spentSerials);
 
         //POS params
         if(IsProofOfStakeHeightActive(Params().GetConsensus().nPosHeightActivate)){
@@ -512,11 +577,16 @@ public:
 
         // sigma params
         if(IsSigmaHeightActive(Params().GetConsensus().nSigmaStartBlock)){
-            READWRITE(mintedPubCoinsV2);
-            READWRITE(accumulatorChangesV2);
-            READWRITE(spentSerialsV2);
+            READWRITE(privacy.mintedPubCoinsV2);
+            READWRITE(privacy.accumulatorChangesV2);
+            READWRITE(privacy.spentSerialsV2);
         }
 
+        if (nStatus & BLOCK_HAVE_GHOSTED)
+            READWRITE(nCycleGhostedValue);
+
+        if (ser_action.ForRead())
+            CompactPrivacyData();
     }
 
     uint256 GetBlockHash() const
@@ -8,6 +8,7 @@
 #include <sync.h>
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 #include <boost/thread/condition_variable.hpp>
@@ -25,6 +26,9 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Instead of dedicated worker threads, the queue can start helpers on a
+  * thread pool as work is added. Helpers return once the queue is empty.
   */
 template <typename T>
 class CCheckQueue
@@ -62,8 +66,15 @@ private:
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
+    //! The number of helpers started and not yet returned, and the limit
+    int nHelpers;
+    int nMaxHelpers;
+
+    //! Starts a helper on a thread pool
+    std::function<void(std::function<void()>)> startHelper;
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    bool Loop(bool fMaster = false, bool fHelper = false)
     {
         boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
@@ -86,6 +97,11 @@ private:
                 }
                 // logically, the do loop starts here
                 while (queue.empty()) {
+                    if (fHelper) {
+                        nTotal--;
+                        nHelpers--;
+                        return fAllOk;
+                    }
                     if (fMaster && nTodo == 0) {
                         nTotal--;
                         bool fRet = fAllOk;
@@ -128,7 +144,7 @@ public:
     boost::mutex ControlMutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn), nHelpers(0), nMaxHelpers(0) {}
 
     //! Worker thread
     void Thread()
@@ -136,6 +152,14 @@ public:
         Loop();
     }
 
+    //! Have up to nMaxHelpersIn helpers started by start while there is work queued
+    void SetHelpers(int nMaxHelpersIn, std::function<void(std::function<void()>)> start)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        nMaxHelpers = std::max(nMaxHelpersIn, 0);
+        startHelper = std::move(start);
+    }
+
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
@@ -145,16 +169,24 @@ public:
     //! Add a batch of checks to the queue
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        for (T& check : vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
+        int nStart;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            for (T& check : vChecks) {
+                queue.push_back(T());
+                check.swap(queue.back());
+            }
+            nTodo += vChecks.size();
+            if (vChecks.size() == 1)
+                condWorker.notify_one();
+            else if (vChecks.size() > 1)
+                condWorker.notify_all();
+            nStart = std::min((int)std::min(vChecks.size(), queue.size()), nMaxHelpers - nHelpers);
+            if (nStart > 0)
+                nHelpers += nStart;
         }
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1)
-            condWorker.notify_one();
-        else if (vChecks.size() > 1)
-            condWorker.notify_all();
+        for (int i = 0; i < nStart; i++)
+            startHelper([this] { Loop(false, true); });
     }
 
     ~CCheckQueue()
@@ -48,6 +48,11 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#define USE_POLL
+#define USE_EPOLL
+#endif
+
 #ifndef WIN32
 typedef unsigned int SOCKET;
 #include <errno.h>
@@ -87,7 +92,7 @@ size_t strnlen( const char *start, size_t max_len);
 #endif // HAVE_DECL_STRNLEN
 
 bool static inline IsSelectableSocket(const SOCKET& s) {
-#ifdef WIN32
+#if defined(USE_POLL) || defined(WIN32)
     return true;
 #else
     return (s < FD_SETSIZE);
@@ -0,0 +1,224 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <executor.h>
+
+#include <util.h>
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <limits>
+
+static const size_t NO_WORKER = std::numeric_limits<size_t>::max();
+
+// Executor and worker index of the current thread, if it is a worker
+static thread_local const CComputeExecutor* tlsExecutor = nullptr;
+static thread_local size_t tlsWorker = NO_WORKER;
+
+CComputeExecutor::CComputeExecutor() : nWorkers(0), nQueued(0), nNextWorker(0), nCallers(0), fStop(false), fExit(false)
+{
+}
+
+CComputeExecutor::~CComputeExecutor()
+{
+    Stop();
+}
+
+void CComputeExecutor::Start(int nThreads)
+{
+    assert(threads.empty());
+    if (nThreads <= 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(csWork);
+        for (int i = 0; i < nThreads; i++)
+            workers.emplace_back(new Worker());
+        fStop = false;
+        fExit = false;
+        nWorkers = nThreads;
+    }
+    for (int i = 0; i < nThreads; i++)
+        threads.emplace_back(&CComputeExecutor::ThreadMain, this, (size_t)i);
+}
+
+void CComputeExecutor::Stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(csWork);
+        fStop = true;
+        nWorkers = 0;
+        // Callers already inside still push to the workers, which keep running for them
+        condCallers.wait(lock, [this] { return nCallers == 0; });
+        fExit = true;
+    }
+    condWork.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+    threads.clear();
+    workers.clear();
+}
+
+size_t CComputeExecutor::EnterCaller()
+{
+    std::lock_guard<std::mutex> lock(csWork);
+    if (fStop || workers.empty())
+        return 0;
+    nCallers++;
+    return workers.size();
+}
+
+void CComputeExecutor::LeaveCaller()
+{
+    std::lock_guard<std::mutex> lock(csWork);
+    if (--nCallers == 0)
+        condCallers.notify_all();
+}
+
+void CComputeExecutor::Post(Task task)
+{
+    size_t n = EnterCaller();
+    if (n == 0) {
+        task();
+        return;
+    }
+    Push(std::move(task), n);
+    LeaveCaller();
+}
+
+void CComputeExecutor::Push(Task task, size_t nWorkerCount)
+{
+    size_t nTarget = tlsExecutor == this ? tlsWorker : nNextWorker++ % nWorkerCount;
+    {
+        std::lock_guard<std::mutex> lock(workers[nTarget]->cs);
+        workers[nTarget]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(csWork);
+        nQueued++;
+    }
+    condWork.notify_one();
+}
+
+bool CComputeExecutor::RunOne(size_t nSelf)
+{
+    // Workers are only cleared after all the threads have exited
+    size_t n = workers.size();
+    Task task;
+    {
+        Worker& worker = *workers[nSelf];
+        std::lock_guard<std::mutex> lock(worker.cs);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !task && i < n; i++) {
+        Worker& victim = *workers[(nSelf + i) % n];
+        std::lock_guard<std::mutex> lock(victim.cs);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+
+    nQueued--;
+    task();
+    return true;
+}
+
+void CComputeExecutor::ThreadMain(size_t nSelf)
+{
+    RenameThread("nix-compute");
+    tlsExecutor = this;
+    tlsWorker = nSelf;
+
+    for (;;) {
+        if (RunOne(nSelf))
+            continue;
+
+        std::unique_lock<std::mutex> lock(csWork);
+        condWork.wait(lock, [this] { return nQueued > 0 || fExit; });
+        if (fExit && nQueued == 0)
+            break;
+    }
+}
+
+void CComputeExecutor::ParallelFor(size_t nCount, const std::function<void(size_t, size_t)>& func, size_t nChunk)
+{
+    if (nCount == 0)
+        return;
+
+    size_t nWorkerCount = EnterCaller();
+    if (nChunk == 0)
+        nChunk = (nCount + nWorkerCount) / (nWorkerCount + 1);
+    size_t nChunks = (nCount + nChunk - 1) / nChunk;
+
+    if (nWorkerCount == 0 || nChunks == 1) {
+        if (nWorkerCount != 0)
+            LeaveCaller();
+        for (size_t nBegin = 0; nBegin < nCount; nBegin += nChunk)
+            func(nBegin, std::min(nBegin + nChunk, nCount));
+        return;
+    }
+
+    // Shared with the tasks, which may still be signalling completion, or
+    // find nothing left to claim, after the caller returns
+    struct State {
+        std::atomic<size_t> nNext;
+        std::mutex cs;
+        std::condition_variable cond;
+        size_t nRemaining;
+        std::exception_ptr error;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->nNext = 0;
+    state->nRemaining = nChunks;
+
+    // Claim and run chunks of this call until there are none left
+    auto runChunks = [state, &func, nCount, nChunk, nChunks]() {
+        for (;;) {
+            size_t i = state->nNext++;
+            if (i >= nChunks)
+                break;
+            std::exception_ptr error;
+            try {
+                func(i * nChunk, std::min((i + 1) * nChunk, nCount));
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->cs);
+            if (error && !state->error)
+                state->error = error;
+            if (--state->nRemaining == 0)
+                state->cond.notify_all();
+        }
+    };
+
+    size_t nTasks = std::min(nChunks - 1, nWorkerCount);
+    for (size_t i = 0; i < nTasks; i++)
+        Push(runChunks, nWorkerCount);
+    LeaveCaller();
+
+    // The caller only takes chunks of its own call, so it never ends up
+    // waiting on an unrelated long task it picked from the queues. Chunks
+    // claimed by other threads are already running and just need waiting for.
+    runChunks();
+    {
+        std::unique_lock<std::mutex> lock(state->cs);
+        state->cond.wait(lock, [&state] { return state->nRemaining == 0; });
+    }
+
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+CComputeExecutor& GetComputeExecutor()
+{
+    static CComputeExecutor executor;
+    return executor;
+}
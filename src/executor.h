@@ -0,0 +1,96 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef NIX_EXECUTOR_H
+#define NIX_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Node-wide pool of compute threads for CPU bound work such as proof
+// generation and verification.
+//
+// Each worker has its own deque of tasks. Tasks submitted from a worker go to
+// the back of its own deque and are taken from there again, tasks submitted
+// from other threads are spread over the workers, and idle workers steal from
+// the front of the other deques. A thread waiting in ParallelFor runs the
+// remaining ranges of its own call itself, so work can be submitted from
+// within a task without deadlocking and the caller counts as one of the
+// threads doing the work.
+//
+// Before Start() is called, after Stop(), or with no worker threads, all work
+// is run on the calling thread.
+//
+class CComputeExecutor
+{
+public:
+    typedef std::function<void()> Task;
+
+    CComputeExecutor();
+    ~CComputeExecutor();
+
+    CComputeExecutor(const CComputeExecutor&) = delete;
+    CComputeExecutor& operator=(const CComputeExecutor&) = delete;
+
+    // Start nThreads worker threads
+    void Start(int nThreads);
+
+    // Run work submitted from now on inline, wait for the calls already
+    // submitting work and for the queued tasks to finish, and stop the threads
+    void Stop();
+
+    // Number of threads that run tasks in parallel, including the caller
+    int GetConcurrency() const { return nWorkers + 1; }
+
+    // Run task on one of the worker threads without waiting for it
+    void Post(Task task);
+
+    // Call func(begin, end) for consecutive ranges covering [0, nCount), in
+    // parallel, and return once all of them are done. Ranges hold nChunk
+    // items; 0 splits the work evenly over GetConcurrency() threads. The
+    // first exception thrown by func is rethrown to the caller.
+    void ParallelFor(size_t nCount, const std::function<void(size_t, size_t)>& func, size_t nChunk = 0);
+
+private:
+    struct Worker {
+        std::mutex cs;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<int> nWorkers;
+
+    std::mutex csWork;
+    std::condition_variable condWork;
+    std::condition_variable condCallers;
+    std::atomic<size_t> nQueued;
+    std::atomic<size_t> nNextWorker;
+    // Calls that may push tasks, workers are only cleared once there are none
+    int nCallers;
+    // No new work is queued once set, workers exit when fExit is set
+    bool fStop;
+    bool fExit;
+
+    // Register a call that pushes tasks, returning the number of workers, or
+    // 0 if the work has to run inline
+    size_t EnterCaller();
+    void LeaveCaller();
+    void Push(Task task, size_t nWorkerCount);
+    // Run one queued task, preferring the given worker's own deque over stealing
+    bool RunOne(size_t nSelf);
+    void ThreadMain(size_t nSelf);
+};
+
+// Executor shared by the whole node, sized from -par
+CComputeExecutor& GetComputeExecutor();
+
+#endif // NIX_EXECUTOR_H
@@ -12,6 +12,7 @@
 #include "netfulfilledman.h"
 #include "util.h"
 #include "netmessagemaker.h"
+#include "executor.h"
 
 /** Ghostnode manager */
 CGhostnodeMan mnodeman;
@@ -97,8 +98,14 @@ void CGhostnodeIndex::RebuildIndex()
     }
 }
 
+SaltedGhostnodeKeyHasher::SaltedGhostnodeKeyHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
 CGhostnodeMan::CGhostnodeMan() : cs(),
-  vGhostnodes(),
+  listGhostnodes(),
+  mapGhostnodesByOutpoint(),
+  mapGhostnodesByPubKey(),
+  mapGhostnodesByCollateral(),
+  mapGhostnodesByAddr(),
   mAskedUsForGhostnodeList(),
   mWeAskedForGhostnodeList(),
   mWeAskedForGhostnodeListEntry(),
@@ -126,7 +133,8 @@ bool CGhostnodeMan::Add(CGhostnode &mn)
     CGhostnode *pmn = Find(mn.vin);
     if (pmn == NULL) {
         //LogPrint("ghostnode", "CGhostnodeMan::Add -- Adding new Ghostnode: addr=%s, %i now\n", mn.addr.ToString(), size() + 1);
-        vGhostnodes.push_back(mn);
+        listGhostnodes.push_back(mn);
+        AddToLookup(&listGhostnodes.back());
         indexGhostnodes.AddGhostnodeVIN(mn.vin);
         fGhostnodesAdded = true;
         return true;
@@ -171,7 +179,7 @@ void CGhostnodeMan::Check()
 
 //    //LogPrint("ghostnode", "CGhostnodeMan::Check -- nLastWatchdogVoteTime=%d, IsWatchdogActive()=%d\n", nLastWatchdogVoteTime, IsWatchdogActive());
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
         mn.Check();
     }
 }
@@ -190,11 +198,11 @@ void CGhostnodeMan::CheckAndRemove()
         Check();
 
         // Remove spent ghostnodes, prepare structures and make requests to reasure the state of inactive ones
-        std::vector<CGhostnode>::iterator it = vGhostnodes.begin();
+        std::list<CGhostnode>::iterator it = listGhostnodes.begin();
         std::vector<std::pair<int, CGhostnode> > vecGhostnodeRanks;
         // ask for up to MNB_RECOVERY_MAX_ASK_ENTRIES ghostnode entries at a time
         int nAskForMnbRecovery = MNB_RECOVERY_MAX_ASK_ENTRIES;
-        while(it != vGhostnodes.end()) {
+        while(it != listGhostnodes.end()) {
             CGhostnodeBroadcast mnb = CGhostnodeBroadcast(*it);
             uint256 hash = mnb.GetHash();
             // If collateral was spent ...
@@ -207,7 +215,8 @@ void CGhostnodeMan::CheckAndRemove()
 
                 // and finally remove it from the list
 //                it->FlagGovernanceItemsAsDirty();
-                it = vGhostnodes.erase(it);
+                RemoveFromLookup(&(*it));
+                it = listGhostnodes.erase(it);
                 fGhostnodesRemoved = true;
             } else {
                 bool fAsk = pCurrentBlockIndex &&
@@ -367,7 +376,10 @@ void CGhostnodeMan::CheckAndRemove()
 void CGhostnodeMan::Clear()
 {
     LOCK(cs);
-    vGhostnodes.clear();
+    listGhostnodes.clear();
+    RebuildLookup();
+    listRankCache.clear();
+    ghostFeePayees.reset();
     mAskedUsForGhostnodeList.clear();
     mWeAskedForGhostnodeList.clear();
     mWeAskedForGhostnodeListEntry.clear();
@@ -385,7 +397,7 @@ int CGhostnodeMan::CountGhostnodes(int nProtocolVersion)
     int nCount = 0;
     nProtocolVersion = nProtocolVersion == -1 ? mnpayments.GetMinGhostnodePaymentsProto() : nProtocolVersion;
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
         if(mn.nProtocolVersion < nProtocolVersion) continue;
         nCount++;
     }
@@ -399,7 +411,7 @@ int CGhostnodeMan::CountEnabled(int nProtocolVersion)
     int nCount = 0;
     nProtocolVersion = nProtocolVersion == -1 ? mnpayments.GetMinGhostnodePaymentsProto() : nProtocolVersion;
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
         if(mn.nProtocolVersion < nProtocolVersion || !mn.IsEnabled()) continue;
         nCount++;
     }
@@ -413,7 +425,7 @@ int CGhostnodeMan::CountByIP(int nNetworkType)
     LOCK(cs);
     int nNodeCount = 0;
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes)
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes)
         if ((nNetworkType == NET_IPV4 && mn.addr.IsIPv4()) ||
             (nNetworkType == NET_TOR  && mn.addr.IsTor())  ||
             (nNetworkType == NET_IPV6 && mn.addr.IsIPv6())) {
@@ -450,10 +462,16 @@ CGhostnode* CGhostnodeMan::Find(const CScript &payee)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes)
-    {
-        if(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()) == payee)
-            return &mn;
+    // ghostnodes are paid to the P2PKH script of their collateral key
+    CTxDestination dest;
+    if(!ExtractDestination(payee, dest)) return NULL;
+    const CKeyID* keyID = boost::get<CKeyID>(&dest);
+    if(!keyID) return NULL;
+
+    auto range = mapGhostnodesByCollateral.equal_range(*keyID);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(GetScriptForDestination(it->second->pubKeyCollateralAddress.GetID()) == payee)
+            return it->second;
     }
     return NULL;
 }
@@ -462,24 +480,55 @@ CGhostnode* CGhostnodeMan::Find(const CTxIn &vin)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes)
-    {
-        if(mn.vin.prevout == vin.prevout)
-            return &mn;
-    }
-    return NULL;
+    auto it = mapGhostnodesByOutpoint.find(vin.prevout);
+    return it != mapGhostnodesByOutpoint.end() ? it->second : NULL;
 }
 
 CGhostnode* CGhostnodeMan::Find(const CPubKey &pubKeyGhostnode)
 {
     LOCK(cs);
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes)
-    {
-        if(mn.pubKeyGhostnode == pubKeyGhostnode)
-            return &mn;
+    auto it = mapGhostnodesByPubKey.find(pubKeyGhostnode);
+    return it != mapGhostnodesByPubKey.end() ? it->second : NULL;
+}
+
+void CGhostnodeMan::AddToLookup(CGhostnode* pmn)
+{
+    mapGhostnodesByOutpoint[pmn->vin.prevout] = pmn;
+    mapGhostnodesByPubKey.emplace(pmn->pubKeyGhostnode, pmn);
+    mapGhostnodesByCollateral.emplace(pmn->pubKeyCollateralAddress.GetID(), pmn);
+    mapGhostnodesByAddr.emplace(pmn->addr, pmn);
+}
+
+template<typename Map, typename Key>
+static void EraseLookupEntry(Map& map, const Key& key, const CGhostnode* pmn)
+{
+    auto range = map.equal_range(key);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(it->second == pmn) {
+            map.erase(it);
+            return;
+        }
+    }
+}
+
+void CGhostnodeMan::RemoveFromLookup(CGhostnode* pmn)
+{
+    mapGhostnodesByOutpoint.erase(pmn->vin.prevout);
+    EraseLookupEntry(mapGhostnodesByPubKey, pmn->pubKeyGhostnode, pmn);
+    EraseLookupEntry(mapGhostnodesByCollateral, pmn->pubKeyCollateralAddress.GetID(), pmn);
+    EraseLookupEntry(mapGhostnodesByAddr, pmn->addr, pmn);
+}
+
+void CGhostnodeMan::RebuildLookup()
+{
+    mapGhostnodesByOutpoint.clear();
+    mapGhostnodesByPubKey.clear();
+    mapGhostnodesByCollateral.clear();
+    mapGhostnodesByAddr.clear();
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
+        AddToLookup(&mn);
     }
-    return NULL;
 }
 
 bool CGhostnodeMan::Get(const CPubKey& pubKeyGhostnode, CGhostnode& ghostnode)
@@ -605,7 +654,7 @@ CGhostnode* CGhostnodeMan::GetNextGhostnodeInQueueForPayment(int nBlockHeight, b
     //LogPrintf("\nGhostnode InQueueForPayment \n");
     int nMnCount = CountEnabled();
     int index = 0;
-    BOOST_FOREACH(CGhostnode &mn, vGhostnodes)
+    BOOST_FOREACH(CGhostnode &mn, listGhostnodes)
     {
         index += 1;
 
@@ -668,7 +717,7 @@ CGhostnode* CGhostnodeMan::FindRandomNotInVec(const std::vector<CTxIn> &vecToExc
 
     // fill a vector of pointers
     std::vector<CGhostnode*> vpGhostnodesShuffled;
-    BOOST_FOREACH(CGhostnode &mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode &mn, listGhostnodes) {
         vpGhostnodesShuffled.push_back(&mn);
     }
 
@@ -697,68 +746,141 @@ CGhostnode* CGhostnodeMan::FindRandomNotInVec(const std::vector<CTxIn> &vecToExc
     return NULL;
 }
 
-int CGhostnodeMan::GetGhostnodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+bool CGhostnodeMan::IsRankEligible(CGhostnode& mn, int nMinProtocol, RankFilter filter)
 {
-    std::vector<std::pair<int64_t, CGhostnode*> > vecGhostnodeScores;
+    if(mn.nProtocolVersion < nMinProtocol) return false;
+    switch(filter) {
+        case RANK_FILTER_ENABLED:           return mn.IsEnabled();
+        case RANK_FILTER_VALID_FOR_PAYMENT: return mn.IsValidForPayment();
+        default:                            return true;
+    }
+}
 
-    //make sure we know about this block
-    uint256 blockHash = uint256();
-    if(!GetBlockHash(blockHash, nBlockHeight)) return -1;
+bool CGhostnodeMan::IsRankTableCurrent(const CRankTable& table)
+{
+    // Same ghostnodes at the same positions must pass the filter, otherwise
+    // vRanked no longer matches listGhostnodes
+    size_t nNext = 0;
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
+        if(!IsRankEligible(mn, table.nMinProtocol, table.filter)) continue;
+        if(nNext == table.vEligible.size()) return false;
+        const std::pair<const CGhostnode*, COutPoint>& eligible = table.vEligible[nNext++];
+        if(eligible.first != &mn || eligible.second != mn.vin.prevout) return false;
+    }
+    return nNext == table.vEligible.size();
+}
 
-    LOCK(cs);
+const CGhostnodeMan::CRankTable& CGhostnodeMan::GetRankTable(const uint256& blockHash, int nBlockHeight, int nMinProtocol, RankFilter filter)
+{
+    AssertLockHeld(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
-        if(mn.nProtocolVersion < nMinProtocol) continue;
-        if(fOnlyActive) {
-            if(!mn.IsEnabled()) continue;
-        }
-        else {
-            if(!mn.IsValidForPayment()) continue;
+    for(std::list<CRankTable>::iterator it = listRankCache.begin(); it != listRankCache.end(); ++it) {
+        if(it->nBlockHeight != nBlockHeight || it->nMinProtocol != nMinProtocol || it->filter != filter) continue;
+        if(it->blockHash != blockHash || !IsRankTableCurrent(*it)) {
+            listRankCache.erase(it);
+            break;
         }
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
+        listRankCache.splice(listRankCache.begin(), listRankCache, it);
+        return listRankCache.front();
+    }
+
+    CRankTable table;
+    table.nBlockHeight = nBlockHeight;
+    table.nMinProtocol = nMinProtocol;
+    table.filter = filter;
+    table.blockHash = blockHash;
 
-        vecGhostnodeScores.push_back(std::make_pair(nScore, &mn));
+    std::vector<std::pair<int64_t, CGhostnode*> > vecGhostnodeScores;
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
+        if(!IsRankEligible(mn, nMinProtocol, filter)) continue;
+        table.vEligible.push_back(std::make_pair(&mn, mn.vin.prevout));
+        vecGhostnodeScores.push_back(std::make_pair(0, &mn));
     }
 
+    // Scores are independent of each other, split large lists between the compute threads
+    size_t nChunk = vecGhostnodeScores.size() < MIN_PARALLEL_SCORE_NODES ? vecGhostnodeScores.size() : 0;
+    GetComputeExecutor().ParallelFor(vecGhostnodeScores.size(), [&](size_t nBegin, size_t nEnd) {
+        for(size_t i = nBegin; i < nEnd; i++)
+            vecGhostnodeScores[i].first = vecGhostnodeScores[i].second->CalculateScore(blockHash).GetCompact(false);
+    }, nChunk);
+
     sort(vecGhostnodeScores.rbegin(), vecGhostnodeScores.rend(), CompareScoreMN());
 
-    int nRank = 0;
+    table.vRanked.reserve(vecGhostnodeScores.size());
+    table.mapRanks.reserve(vecGhostnodeScores.size());
     BOOST_FOREACH (PAIRTYPE(int64_t, CGhostnode*)& scorePair, vecGhostnodeScores) {
-        nRank++;
-        if(scorePair.second->vin.prevout == vin.prevout) return nRank;
+        table.vRanked.push_back(scorePair.second);
+        table.mapRanks.emplace(scorePair.second->vin.prevout, (int)table.vRanked.size());
     }
 
-    return -1;
+    listRankCache.push_front(std::move(table));
+    if(listRankCache.size() > RANK_CACHE_SIZE) listRankCache.pop_back();
+    return listRankCache.front();
 }
 
-std::vector<std::pair<int, CGhostnode> > CGhostnodeMan::GetGhostnodeRanks(int nBlockHeight, int nMinProtocol)
+int CGhostFeePayees::CountPaid(const std::vector<CTxOut>& vout, CAmount feePayout) const
 {
-    std::vector<std::pair<int64_t, CGhostnode*> > vecGhostnodeScores;
-    std::vector<std::pair<int, CGhostnode> > vecGhostnodeRanks;
+    std::unordered_map<CScript, int, SaltedGhostnodeKeyHasher> mapOutputCount(0, mapPayeeCount.hash_function());
+    BOOST_FOREACH(const CTxOut& out, vout) {
+        if(out.nValue == feePayout && mapPayeeCount.count(out.scriptPubKey))
+            mapOutputCount[out.scriptPubKey]++;
+    }
+
+    int nPaid = 0;
+    for(const auto& outputCount : mapOutputCount) {
+        nPaid += std::min(outputCount.second, mapPayeeCount.at(outputCount.first));
+    }
+    return nPaid;
+}
 
+CGhostFeePayeesRef CGhostnodeMan::GetGhostFeePayees(const uint256& hashTip, int64_t nActiveBefore)
+{
+    LOCK(cs);
+
+    if(ghostFeePayees && hashGhostFeePayeesTip == hashTip && ghostFeePayees->nActiveBefore == nActiveBefore)
+        return ghostFeePayees;
+
+    std::shared_ptr<CGhostFeePayees> payees = std::make_shared<CGhostFeePayees>(nActiveBefore);
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
+        if(!mn.IsEnabled() || mn.sigTime > nActiveBefore) continue;
+        payees->vPayees.push_back(GetScriptForDestination(mn.pubKeyCollateralAddress.GetID()));
+        payees->mapPayeeCount[payees->vPayees.back()]++;
+    }
+
+    ghostFeePayees = payees;
+    hashGhostFeePayeesTip = hashTip;
+    return ghostFeePayees;
+}
+
+int CGhostnodeMan::GetGhostnodeRank(const CTxIn& vin, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
+{
     //make sure we know about this block
     uint256 blockHash = uint256();
-    if(!GetBlockHash(blockHash, nBlockHeight)) return vecGhostnodeRanks;
+    if(!GetBlockHash(blockHash, nBlockHeight)) return -1;
 
     LOCK(cs);
 
-    // scan for winner
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    const CRankTable& table = GetRankTable(blockHash, nBlockHeight, nMinProtocol, fOnlyActive ? RANK_FILTER_ENABLED : RANK_FILTER_VALID_FOR_PAYMENT);
 
-        if(mn.nProtocolVersion < nMinProtocol || !mn.IsEnabled()) continue;
+    auto it = table.mapRanks.find(vin.prevout);
+    return it != table.mapRanks.end() ? it->second : -1;
+}
 
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
+std::vector<std::pair<int, CGhostnode> > CGhostnodeMan::GetGhostnodeRanks(int nBlockHeight, int nMinProtocol)
+{
+    std::vector<std::pair<int, CGhostnode> > vecGhostnodeRanks;
 
-        vecGhostnodeScores.push_back(std::make_pair(nScore, &mn));
-    }
+    //make sure we know about this block
+    uint256 blockHash = uint256();
+    if(!GetBlockHash(blockHash, nBlockHeight)) return vecGhostnodeRanks;
 
-    sort(vecGhostnodeScores.rbegin(), vecGhostnodeScores.rend(), CompareScoreMN());
+    LOCK(cs);
+
+    const CRankTable& table = GetRankTable(blockHash, nBlockHeight, nMinProtocol, RANK_FILTER_ENABLED);
 
-    int nRank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CGhostnode*)& s, vecGhostnodeScores) {
-        nRank++;
-        vecGhostnodeRanks.push_back(std::make_pair(nRank, *s.second));
+    vecGhostnodeRanks.reserve(table.vRanked.size());
+    for(size_t i = 0; i < table.vRanked.size(); i++) {
+        vecGhostnodeRanks.push_back(std::make_pair((int)i + 1, *table.vRanked[i]));
     }
 
     return vecGhostnodeRanks;
@@ -766,8 +888,6 @@ std::vector<std::pair<int, CGhostnode> > CGhostnodeMan::GetGhostnodeRanks(int nB
 
 CGhostnode* CGhostnodeMan::GetGhostnodeByRank(int nRank, int nBlockHeight, int nMinProtocol, bool fOnlyActive)
 {
-    std::vector<std::pair<int64_t, CGhostnode*> > vecGhostnodeScores;
-
     LOCK(cs);
 
     uint256 blockHash;
@@ -776,28 +896,10 @@ CGhostnode* CGhostnodeMan::GetGhostnodeByRank(int nRank, int nBlockHeight, int n
         return NULL;
     }
 
-    // Fill scores
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
-
-        if(mn.nProtocolVersion < nMinProtocol) continue;
-        if(fOnlyActive && !mn.IsEnabled()) continue;
-
-        int64_t nScore = mn.CalculateScore(blockHash).GetCompact(false);
-
-        vecGhostnodeScores.push_back(std::make_pair(nScore, &mn));
-    }
-
-    sort(vecGhostnodeScores.rbegin(), vecGhostnodeScores.rend(), CompareScoreMN());
-
-    int rank = 0;
-    BOOST_FOREACH (PAIRTYPE(int64_t, CGhostnode*)& s, vecGhostnodeScores){
-        rank++;
-        if(rank == nRank) {
-            return s.second;
-        }
-    }
+    const CRankTable& table = GetRankTable(blockHash, nBlockHeight, nMinProtocol, fOnlyActive ? RANK_FILTER_ENABLED : RANK_FILTER_ALL);
 
-    return NULL;
+    if(nRank < 1 || nRank > (int)table.vRanked.size()) return NULL;
+    return table.vRanked[nRank - 1];
 }
 
 void CGhostnodeMan::ProcessGhostnodeConnections()
@@ -948,7 +1050,7 @@ void CGhostnodeMan::ProcessMessage(CNode* pfrom, std::string& strCommand, CDataS
 
         int nInvCount = 0;
 
-        BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+        BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
             if (vin != CTxIn() && vin != mn.vin) continue; // asked for specific vin but we are not there yet
             if (mn.addr.IsRFC1918() || mn.addr.IsLocal()) continue; // do not send local network ghostnode
             if (mn.IsUpdateRequired()) continue; // do not send outdated ghostnodes
@@ -1043,7 +1145,7 @@ void CGhostnodeMan::DoFullVerificationStep()
     if(nOffset >= (int)vecGhostnodeRanks.size()) return;
 
     std::vector<CGhostnode*> vSortedByAddr;
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
         vSortedByAddr.push_back(&mn);
     }
 
@@ -1166,7 +1268,7 @@ void CGhostnodeMan::DoFullVerificationStep()
 
 void CGhostnodeMan::CheckSameAddr()
 {
-    if(!ghostnodeSync.IsSynced() || vGhostnodes.empty()) return;
+    if(!ghostnodeSync.IsSynced() || listGhostnodes.empty()) return;
 
     std::vector<CGhostnode*> vBan;
     std::vector<CGhostnode*> vSortedByAddr;
@@ -1177,7 +1279,7 @@ void CGhostnodeMan::CheckSameAddr()
         CGhostnode* pprevGhostnode = NULL;
         CGhostnode* pverifiedGhostnode = NULL;
 
-        BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+        BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
             vSortedByAddr.push_back(&mn);
         }
 
@@ -1330,47 +1432,45 @@ void CGhostnodeMan::ProcessVerifyReply(CNode* pnode, CGhostnodeVerification& mnv
 
         CGhostnode* prealGhostnode = NULL;
         std::vector<CGhostnode*> vpGhostnodesToBan;
-        std::vector<CGhostnode>::iterator it = vGhostnodes.begin();
         std::string strMessage1 = strprintf("%s%d%s", pnode->addr.ToString(), mnv.nonce, blockHash.ToString());
-        while(it != vGhostnodes.end()) {
-            if(CAddress(it->addr, NODE_NETWORK) == pnode->addr) {
-                if(darkSendSigner.VerifyMessage(it->pubKeyGhostnode, mnv.vchSig1, strMessage1, strError)) {
-                    // found it!
-                    prealGhostnode = &(*it);
-                    if(!it->IsPoSeVerified()) {
-                        it->DecreasePoSeBanScore();
-                    }
-                    netfulfilledman.AddFulfilledRequest(pnode->addr, strprintf("%s", NetMsgType::MNVERIFY)+"-done");
-
-                    // we can only broadcast it if we are an activated ghostnode
-                    if(activeGhostnode.vin == CTxIn()) continue;
-                    // update ...
-                    mnv.addr = it->addr;
-                    mnv.vin1 = it->vin;
-                    mnv.vin2 = activeGhostnode.vin;
-                    std::string strMessage2 = strprintf("%s%d%s%s%s", mnv.addr.ToString(), mnv.nonce, blockHash.ToString(),
-                                            mnv.vin1.prevout.ToStringShort(), mnv.vin2.prevout.ToStringShort());
-                    // ... and sign it
-                    if(!darkSendSigner.SignMessage(strMessage2, mnv.vchSig2, activeGhostnode.keyGhostnode)) {
-                        //LogPrint("GhostnodeMan::ProcessVerifyReply -- SignMessage() failed\n");
-                        return;
-                    }
+        auto range = mapGhostnodesByAddr.equal_range(pnode->addr);
+        for(auto itAddr = range.first; itAddr != range.second; ++itAddr) {
+            CGhostnode* pmn = itAddr->second;
+            if(darkSendSigner.VerifyMessage(pmn->pubKeyGhostnode, mnv.vchSig1, strMessage1, strError)) {
+                // found it!
+                prealGhostnode = pmn;
+                if(!pmn->IsPoSeVerified()) {
+                    pmn->DecreasePoSeBanScore();
+                }
+                netfulfilledman.AddFulfilledRequest(pnode->addr, strprintf("%s", NetMsgType::MNVERIFY)+"-done");
+
+                // we can only broadcast it if we are an activated ghostnode
+                if(activeGhostnode.vin == CTxIn()) continue;
+                // update ...
+                mnv.addr = pmn->addr;
+                mnv.vin1 = pmn->vin;
+                mnv.vin2 = activeGhostnode.vin;
+                std::string strMessage2 = strprintf("%s%d%s%s%s", mnv.addr.ToString(), mnv.nonce, blockHash.ToString(),
+                                        mnv.vin1.prevout.ToStringShort(), mnv.vin2.prevout.ToStringShort());
+                // ... and sign it
+                if(!darkSendSigner.SignMessage(strMessage2, mnv.vchSig2, activeGhostnode.keyGhostnode)) {
+                    //LogPrint("GhostnodeMan::ProcessVerifyReply -- SignMessage() failed\n");
+                    return;
+                }
 
-                    std::string strError;
+                std::string strError;
 
-                    if(!darkSendSigner.VerifyMessage(activeGhostnode.pubKeyGhostnode, mnv.vchSig2, strMessage2, strError)) {
-                        //LogPrint("GhostnodeMan::ProcessVerifyReply -- VerifyMessage() failed, error: %s\n", strError);
-                        return;
-                    }
+                if(!darkSendSigner.VerifyMessage(activeGhostnode.pubKeyGhostnode, mnv.vchSig2, strMessage2, strError)) {
+                    //LogPrint("GhostnodeMan::ProcessVerifyReply -- VerifyMessage() failed, error: %s\n", strError);
+                    return;
+                }
 
-                    mWeAskedForVerification[pnode->addr] = mnv;
-                    mnv.Relay();
+                mWeAskedForVerification[pnode->addr] = mnv;
+                mnv.Relay();
 
-                } else {
-                    vpGhostnodesToBan.push_back(&(*it));
-                }
+            } else {
+                vpGhostnodesToBan.push_back(pmn);
             }
-            ++it;
         }
         // no real ghostnode found?...
         if(!prealGhostnode) {
@@ -1484,7 +1584,7 @@ void CGhostnodeMan::ProcessVerifyBroadcast(CNode* pnode, const CGhostnodeVerific
 
         // increase ban score for everyone else with the same addr
         int nCount = 0;
-        BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+        BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
             if(mn.addr != mnv.addr || mn.vin.prevout == mnv.vin1.prevout) continue;
             mn.IncreasePoSeBanScore();
             nCount++;
@@ -1500,7 +1600,7 @@ std::string CGhostnodeMan::ToString() const
 {
     std::ostringstream info;
 
-    info << "Ghostnodes: " << (int)vGhostnodes.size() <<
+    info << "Ghostnodes: " << (int)listGhostnodes.size() <<
             ", peers who asked us for Ghostnode list: " << (int)mAskedUsForGhostnodeList.size() <<
             ", peers we asked for Ghostnode list: " << (int)mWeAskedForGhostnodeList.size() <<
             ", entries in Ghostnode list we asked for: " << (int)mWeAskedForGhostnodeListEntry.size() <<
@@ -1528,7 +1628,11 @@ void CGhostnodeMan::UpdateGhostnodeList(CGhostnodeBroadcast mnb)
             }
         } else {
             CGhostnodeBroadcast mnbOld = mapSeenGhostnodeBroadcast[CGhostnodeBroadcast(*pmn).GetHash()].second;
-            if (pmn->UpdateFromNewBroadcast(mnb)) {
+            // a new broadcast can change the ghostnode key and address
+            RemoveFromLookup(pmn);
+            bool fUpdated = pmn->UpdateFromNewBroadcast(mnb);
+            AddToLookup(pmn);
+            if (fUpdated) {
                 ghostnodeSync.AddedGhostnodeList();
                 mapSeenGhostnodeBroadcast.erase(mnbOld.GetHash());
             }
@@ -1593,7 +1697,11 @@ bool CGhostnodeMan::CheckMnbAndUpdateGhostnodeList(CNode* pfrom, CGhostnodeBroad
         CGhostnode *pmn = Find(mnb.vin);
         if (pmn) {
             CGhostnodeBroadcast mnbOld = mapSeenGhostnodeBroadcast[CGhostnodeBroadcast(*pmn).GetHash()].second;
-            if (!mnb.Update(pmn, nDos)) {
+            // a new broadcast can change the ghostnode key and address
+            RemoveFromLookup(pmn);
+            bool fUpdated = mnb.Update(pmn, nDos);
+            AddToLookup(pmn);
+            if (!fUpdated) {
                 //LogPrint("ghostnode", "CGhostnodeMan::CheckMnbAndUpdateGhostnodeList -- Update() failed, ghostnode=%s\n", mnb.vin.prevout.ToStringShort());
                 return false;
             }
@@ -1647,7 +1755,7 @@ void CGhostnodeMan::UpdateLastPaid()
     //LogPrint("mnpayments", "CGhostnodeMan::UpdateLastPaid -- nHeight=%d, nMaxBlocksToScanBack=%d, IsFirstRun=%s\n",
                             // pCurrentBlockIndex->nHeight, nMaxBlocksToScanBack, IsFirstRun ? "true" : "false");
 
-    BOOST_FOREACH(CGhostnode& mn, vGhostnodes) {
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
         mn.UpdateLastPaid(pCurrentBlockIndex, nMaxBlocksToScanBack);
     }
 
@@ -1667,14 +1775,14 @@ void CGhostnodeMan::CheckAndRebuildGhostnodeIndex()
         return;
     }
 
-    if(indexGhostnodes.GetSize() <= int(vGhostnodes.size())) {
+    if(indexGhostnodes.GetSize() <= int(listGhostnodes.size())) {
         return;
     }
 
     indexGhostnodesOld = indexGhostnodes;
     indexGhostnodes.Clear();
-    for(size_t i = 0; i < vGhostnodes.size(); ++i) {
-        indexGhostnodes.AddGhostnodeVIN(vGhostnodes[i].vin);
+    BOOST_FOREACH(CGhostnode& mn, listGhostnodes) {
+        indexGhostnodes.AddGhostnodeVIN(mn.vin);
     }
 
     fIndexRebuilt = true;
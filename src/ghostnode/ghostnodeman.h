@@ -6,13 +6,69 @@
 #ifndef GHOSTNODEMAN_H
 #define GHOSTNODEMAN_H
 
+#include "coins.h"
 #include "ghostnode.h"
+#include "hash.h"
+#include "pubkey.h"
 #include "sync.h"
 
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 using namespace std;
 
 class CGhostnodeMan;
 
+/** Salted hasher for the ghostnode key lookup maps in CGhostnodeMan */
+class SaltedGhostnodeKeyHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedGhostnodeKeyHasher();
+
+    size_t operator()(const CPubKey& pubKey) const {
+        return CSipHasher(k0, k1).Write(pubKey.begin(), pubKey.size()).Finalize();
+    }
+
+    size_t operator()(const CKeyID& keyID) const {
+        return CSipHasher(k0, k1).Write(keyID.begin(), keyID.size()).Finalize();
+    }
+
+    size_t operator()(const CScript& script) const {
+        return CSipHasher(k0, k1).Write(script.data(), script.size()).Finalize();
+    }
+};
+
+/**
+ * Immutable view of the ghostnodes sharing a ghost fee payout: enabled
+ * ghostnodes announced no later than nActiveBefore, taken once per chain tip
+ * by CGhostnodeMan::GetGhostFeePayees().
+ */
+class CGhostFeePayees
+{
+public:
+    int64_t nActiveBefore;
+    /// payee script of every eligible ghostnode, in list order
+    std::vector<CScript> vPayees;
+    /// number of eligible ghostnodes paying to each script
+    std::unordered_map<CScript, int, SaltedGhostnodeKeyHasher> mapPayeeCount;
+
+    CGhostFeePayees(int64_t nActiveBeforeIn) : nActiveBefore(nActiveBeforeIn) {}
+
+    bool IsEmpty() const { return vPayees.empty(); }
+    int GetCount() const { return vPayees.size(); }
+
+    /// Number of ghostnodes paid feePayout by vout, each eligible ghostnode counted once
+    int CountPaid(const std::vector<CTxOut>& vout, CAmount feePayout) const;
+};
+
+typedef std::shared_ptr<const CGhostFeePayees> CGhostFeePayeesRef;
+
 extern CGhostnodeMan mnodeman;
 
 /**
@@ -111,12 +167,50 @@ private:
     static const int MNB_RECOVERY_WAIT_SECONDS      = 60;
     static const int MNB_RECOVERY_RETRY_SECONDS     = 3 * 60 * 60;
 
+    /// Number of score rankings kept in the rank cache
+    static const size_t RANK_CACHE_SIZE             = 8;
+
+    /// Minimum number of ghostnodes before scores are calculated on several threads
+    static const size_t MIN_PARALLEL_SCORE_NODES    = 512;
+
+    /// Which ghostnodes take part in a score ranking
+    enum RankFilter {
+        RANK_FILTER_ALL,                // any state
+        RANK_FILTER_ENABLED,            // IsEnabled()
+        RANK_FILTER_VALID_FOR_PAYMENT,  // IsValidForPayment()
+    };
+
+    /**
+     * Ghostnodes ordered by score for one block, see GetRankTable().
+     *
+     * vEligible remembers which entries of listGhostnodes were ranked, in
+     * list order, so a cached table can be checked against the current list
+     * without calculating any scores.
+     */
+    struct CRankTable
+    {
+        int nBlockHeight;
+        int nMinProtocol;
+        RankFilter filter;
+        uint256 blockHash;
+        std::vector<std::pair<const CGhostnode*, COutPoint> > vEligible;
+        /// entries of listGhostnodes, best score first
+        std::vector<CGhostnode*> vRanked;
+        /// outpoint -> 1-based rank
+        std::unordered_map<COutPoint, int, SaltedOutpointHasher> mapRanks;
+    };
+
 
     // Keep track of current block index
     const CBlockIndex *pCurrentBlockIndex;
 
-    // map to hold all MNs
-    std::vector<CGhostnode> vGhostnodes;
+    // list to hold all MNs, entries stay at the same address until they are removed
+    std::list<CGhostnode> listGhostnodes;
+    // lookup maps into listGhostnodes, kept in sync by AddToLookup/RemoveFromLookup
+    std::unordered_map<COutPoint, CGhostnode*, SaltedOutpointHasher> mapGhostnodesByOutpoint;
+    std::unordered_multimap<CPubKey, CGhostnode*, SaltedGhostnodeKeyHasher> mapGhostnodesByPubKey;
+    std::unordered_multimap<CKeyID, CGhostnode*, SaltedGhostnodeKeyHasher> mapGhostnodesByCollateral;
+    std::multimap<CService, CGhostnode*> mapGhostnodesByAddr;
     // who's asked for the Ghostnode list and the last time
     std::map<CNetAddr, int64_t> mAskedUsForGhostnodeList;
     // who we asked for the Ghostnode list and the last time
@@ -137,6 +231,13 @@ private:
 
     CGhostnodeIndex indexGhostnodesOld;
 
+    /// Most recently used score rankings, front is the newest
+    std::list<CRankTable> listRankCache;
+
+    /// Ghost fee payees for the chain tip hashGhostFeePayeesTip
+    CGhostFeePayeesRef ghostFeePayees;
+    uint256 hashGhostFeePayeesTip;
+
     /// Set when index has been rebuilt, clear when read
     bool fIndexRebuilt;
 
@@ -152,6 +253,15 @@ private:
 
     friend class CGhostnodeSync;
 
+    /// Score ranking of the ghostnodes passing filter at block blockHash, built on a cache miss
+    const CRankTable& GetRankTable(const uint256& blockHash, int nBlockHeight, int nMinProtocol, RankFilter filter);
+    bool IsRankTableCurrent(const CRankTable& table);
+    static bool IsRankEligible(CGhostnode& mn, int nMinProtocol, RankFilter filter);
+
+    void AddToLookup(CGhostnode* pmn);
+    void RemoveFromLookup(CGhostnode* pmn);
+    void RebuildLookup();
+
 public:
     // critical section to protect the inner data structures
     mutable CCriticalSection cs;
@@ -179,7 +289,16 @@ public:
             READWRITE(strVersion);
         }
 
-        READWRITE(vGhostnodes);
+        if(ser_action.ForRead()) {
+            std::vector<CGhostnode> vGhostnodes;
+            READWRITE(vGhostnodes);
+            listGhostnodes.assign(vGhostnodes.begin(), vGhostnodes.end());
+            RebuildLookup();
+        }
+        else {
+            std::vector<CGhostnode> vGhostnodes(listGhostnodes.begin(), listGhostnodes.end());
+            READWRITE(vGhostnodes);
+        }
         READWRITE(mAskedUsForGhostnodeList);
         READWRITE(mWeAskedForGhostnodeList);
         READWRITE(mWeAskedForGhostnodeListEntry);
@@ -294,7 +413,10 @@ public:
     /// Find a random entry
     CGhostnode* FindRandomNotInVec(const std::vector<CTxIn> &vecToExclude, int nProtocolVersion = -1);
 
-    std::vector<CGhostnode> GetFullGhostnodeVector() { return vGhostnodes; }
+    std::vector<CGhostnode> GetFullGhostnodeVector() { LOCK(cs); return std::vector<CGhostnode>(listGhostnodes.begin(), listGhostnodes.end()); }
+
+    /// Ghostnodes sharing the ghost fees paid on top of hashTip, built once per tip
+    CGhostFeePayeesRef GetGhostFeePayees(const uint256& hashTip, int64_t nActiveBefore);
 
     std::vector<std::pair<int, CGhostnode> > GetGhostnodeRanks(int nBlockHeight = -1, int nMinProtocol=0);
     int GetGhostnodeRank(const CTxIn &vin, int nBlockHeight, int nMinProtocol=0, bool fOnlyActive=true);
@@ -315,7 +437,7 @@ public:
     void ProcessVerifyBroadcast(CNode* pnode, const CGhostnodeVerification& mnv);
 
     /// Return the number of (unique) Ghostnodes
-    int size() { return vGhostnodes.size(); }
+    int size() { return listGhostnodes.size(); }
 
     std::string ToString() const;
 
@@ -144,21 +144,14 @@ namespace libzerocoin {
 
         Bignum c = Bignum(hasher.GetHash()); //this hash should be of length k_prime bits
 
-        Bignum st_1_prime = (valueOfCommitmentToCoin.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sg.pow_mod(s_alpha, params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_phi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_2_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) * ((valueOfCommitmentToCoin *
-                                                                                              sg.inverse(
-                                                                                                      params->accumulatorPoKCommitmentGroup.modulus)).pow_mod(
-                s_gamma, params->accumulatorPoKCommitmentGroup.modulus)) *
-                             sh.pow_mod(s_psi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
-        Bignum st_3_prime = (sg.pow_mod(c, params->accumulatorPoKCommitmentGroup.modulus) *
-                             (sg * valueOfCommitmentToCoin).pow_mod(s_sigma,
-                                                                    params->accumulatorPoKCommitmentGroup.modulus) *
-                             sh.pow_mod(s_xi, params->accumulatorPoKCommitmentGroup.modulus)) %
-                            params->accumulatorPoKCommitmentGroup.modulus;
+        // powers of sg and sh come from the precomputed tables of the group
+        const IntegerGroupParams &pokGroup = params->accumulatorPoKCommitmentGroup;
+        Bignum st_1_prime = valueOfCommitmentToCoin.pow_mod(c, pokGroup.modulus).mul_mod(
+                                pokGroup.ghPow(s_alpha, s_phi), pokGroup.modulus);
+        Bignum st_2_prime = (valueOfCommitmentToCoin * sg.inverse(pokGroup.modulus)).pow_mod(s_gamma, pokGroup.modulus).mul_mod(
+                                pokGroup.ghPow(c, s_psi), pokGroup.modulus);
+        Bignum st_3_prime = (sg * valueOfCommitmentToCoin).pow_mod(s_sigma, pokGroup.modulus).mul_mod(
+                                pokGroup.ghPow(c, s_xi), pokGroup.modulus);
 
         Bignum t_1_prime =
                 (C_r.pow_mod(c, params->accumulatorModulus) * h_n.pow_mod(s_zeta, params->accumulatorModulus) *
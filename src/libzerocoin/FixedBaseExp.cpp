@@ -0,0 +1,107 @@
+/**
+* @file       FixedBaseExp.cpp
+*
+* @brief      Fixed-base modular exponentiation for the Zerocoin library.
+*
+* @copyright  Copyright 2019 The NIX Core Developers
+* @license    This project is released under the MIT license.
+**/
+
+#include "libzerocoin/Zerocoin.h"
+
+namespace libzerocoin {
+
+static const int WINDOW_ENTRIES = (1 << FixedBaseExp::WINDOW_BITS) - 1;
+
+FixedBaseExp::FixedBaseExp(const CBigNum& base, const CBigNum& modulus, const CBigNum& order)
+	: base(base), modulus(modulus), order(order), nWindows((order.bitSize() + WINDOW_BITS - 1) / WINDOW_BITS) {
+
+	CAutoBN_CTX ctx;
+	mont = BN_MONT_CTX_new();
+	if (mont == NULL || !BN_MONT_CTX_set(mont, &modulus, ctx)) {
+		BN_MONT_CTX_free(mont);
+		throw bignum_error("FixedBaseExp : BN_MONT_CTX_set failed");
+	}
+
+	// windowBase runs through base^(2^(WINDOW_BITS * i))
+	CBigNum windowBase;
+	if (!BN_to_montgomery(&windowBase, &base, mont, ctx)) {
+		BN_MONT_CTX_free(mont);
+		throw bignum_error("FixedBaseExp : BN_to_montgomery failed");
+	}
+
+	// CBigNum overloads operator&, so entries are addressed by index
+	table.resize((size_t)nWindows * WINDOW_ENTRIES);
+	for (int i = 0; i < nWindows; i++) {
+		size_t first = (size_t)i * WINDOW_ENTRIES;
+		table[first] = windowBase;
+		for (size_t d = 1; d < (size_t)WINDOW_ENTRIES; d++) {
+			if (!BN_mod_mul_montgomery(&table[first + d], &table[first + d - 1], &windowBase, mont, ctx)) {
+				BN_MONT_CTX_free(mont);
+				throw bignum_error("FixedBaseExp : BN_mod_mul_montgomery failed");
+			}
+		}
+		if (!BN_mod_mul_montgomery(&windowBase, &table[first + WINDOW_ENTRIES - 1], &windowBase, mont, ctx)) {
+			BN_MONT_CTX_free(mont);
+			throw bignum_error("FixedBaseExp : BN_mod_mul_montgomery failed");
+		}
+	}
+}
+
+FixedBaseExp::~FixedBaseExp() {
+	BN_MONT_CTX_free(mont);
+}
+
+void FixedBaseExp::mulPow(CBigNum& acc, bool& fAccSet, const CBigNum& e, BN_CTX* ctx) const {
+	CBigNum exponent;
+	if (!BN_nnmod(&exponent, &e, &order, ctx))
+		throw bignum_error("FixedBaseExp::mulPow : BN_nnmod failed");
+
+	for (int i = 0; i < nWindows; i++) {
+		int d = 0;
+		for (int bit = WINDOW_BITS - 1; bit >= 0; bit--)
+			d = (d << 1) | BN_is_bit_set(&exponent, i * WINDOW_BITS + bit);
+		if (d == 0)
+			continue;
+
+		const CBigNum& entry = table[(size_t)i * WINDOW_ENTRIES + d - 1];
+		if (!fAccSet) {
+			acc = entry;
+			fAccSet = true;
+		} else if (!BN_mod_mul_montgomery(&acc, &acc, &entry, mont, ctx)) {
+			throw bignum_error("FixedBaseExp::mulPow : BN_mod_mul_montgomery failed");
+		}
+	}
+}
+
+CBigNum FixedBaseExp::finish(const CBigNum& acc, bool fAccSet, BN_CTX* ctx) const {
+	if (!fAccSet)
+		return CBigNum(1);
+
+	CBigNum ret;
+	if (!BN_from_montgomery(&ret, &acc, mont, ctx))
+		throw bignum_error("FixedBaseExp::finish : BN_from_montgomery failed");
+	return ret;
+}
+
+CBigNum FixedBaseExp::pow(const CBigNum& e) const {
+	CAutoBN_CTX ctx;
+	CBigNum acc;
+	bool fAccSet = false;
+	mulPow(acc, fAccSet, e, ctx);
+	return finish(acc, fAccSet, ctx);
+}
+
+CBigNum FixedBaseExp::pow2(const FixedBaseExp& a, const CBigNum& x, const FixedBaseExp& b, const CBigNum& y) {
+	if (a.modulus != b.modulus)
+		throw ZerocoinException("FixedBaseExp::pow2 : bases of different groups");
+
+	CAutoBN_CTX ctx;
+	CBigNum acc;
+	bool fAccSet = false;
+	a.mulPow(acc, fAccSet, x, ctx);
+	b.mulPow(acc, fAccSet, y, ctx);
+	return a.finish(acc, fAccSet, ctx);
+}
+
+} /* namespace libzerocoin */
@@ -0,0 +1,67 @@
+/**
+* @file       FixedBaseExp.h
+*
+* @brief      Fixed-base modular exponentiation for the Zerocoin library.
+*
+* @copyright  Copyright 2019 The NIX Core Developers
+* @license    This project is released under the MIT license.
+**/
+
+#ifndef FIXEDBASEEXP_H_
+#define FIXEDBASEEXP_H_
+
+#include <vector>
+
+#include "libzerocoin/bignum.h"
+
+namespace libzerocoin {
+
+/**
+ * Powers of a base of known prime order, precomputed so that raising it to any
+ * exponent takes one modular multiplication per exponent window and no squarings.
+ * Exponents are reduced modulo the order of the base, so negative exponents work
+ * the same as with CBigNum::pow_mod.
+ */
+class FixedBaseExp {
+public:
+	static const int WINDOW_BITS = 5;
+
+	/**
+	 * @param base     the fixed base
+	 * @param modulus  modulus of the group, must be odd
+	 * @param order    order of the base in the group
+	 */
+	FixedBaseExp(const CBigNum& base, const CBigNum& modulus, const CBigNum& order);
+	~FixedBaseExp();
+
+	FixedBaseExp(const FixedBaseExp&) = delete;
+	FixedBaseExp& operator=(const FixedBaseExp&) = delete;
+
+	const CBigNum& getBase() const { return base; }
+	const CBigNum& getModulus() const { return modulus; }
+
+	/// base^e mod modulus
+	CBigNum pow(const CBigNum& e) const;
+
+	/// a^x * b^y mod modulus, computed in a single pass. Both tables must share the modulus.
+	static CBigNum pow2(const FixedBaseExp& a, const CBigNum& x, const FixedBaseExp& b, const CBigNum& y);
+
+private:
+	/// Multiplies acc, in Montgomery form, by base^e. Sets acc if it is still empty.
+	void mulPow(CBigNum& acc, bool& fAccSet, const CBigNum& e, BN_CTX* ctx) const;
+
+	/// acc converted back from Montgomery form, or 1 if it is empty
+	CBigNum finish(const CBigNum& acc, bool fAccSet, BN_CTX* ctx) const;
+
+	CBigNum base;
+	CBigNum modulus;
+	CBigNum order;
+	int nWindows;
+	BN_MONT_CTX* mont;
+	/// base^(d * 2^(WINDOW_BITS * i)) in Montgomery form at index i * (2^WINDOW_BITS - 1) + d - 1
+	std::vector<CBigNum> table;
+};
+
+} /* namespace libzerocoin */
+
+#endif /* FIXEDBASEEXP_H_ */
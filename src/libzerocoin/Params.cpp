@@ -31,10 +31,28 @@ AccumulatorAndProofParams::AccumulatorAndProofParams() {
 	this->initialized = false;
 }
 
-IntegerGroupParams::IntegerGroupParams() {
+IntegerGroupParams::IntegerGroupParams() : gTable(new FixedBaseTable), hTable(new FixedBaseTable) {
 	this->initialized = false;
 }
 
+IntegerGroupParams::IntegerGroupParams(const IntegerGroupParams& other) :
+	initialized(other.initialized), g(other.g), h(other.h), modulus(other.modulus), groupOrder(other.groupOrder),
+	gTable(new FixedBaseTable), hTable(new FixedBaseTable) {
+}
+
+IntegerGroupParams& IntegerGroupParams::operator=(const IntegerGroupParams& other) {
+	if (this != &other) {
+		this->initialized = other.initialized;
+		this->g = other.g;
+		this->h = other.h;
+		this->modulus = other.modulus;
+		this->groupOrder = other.groupOrder;
+		this->gTable.reset(new FixedBaseTable);
+		this->hTable.reset(new FixedBaseTable);
+	}
+	return *this;
+}
+
 Bignum IntegerGroupParams::randomElement() const {
 	// The generator of the group raised
 	// to a random number less than the order of the group
@@ -42,4 +60,33 @@ Bignum IntegerGroupParams::randomElement() const {
 	return this->g.pow_mod(Bignum::randBignum(this->groupOrder),this->modulus);
 }
 
+const FixedBaseExp* IntegerGroupParams::getTable(const CBigNum& base, FixedBaseTable& table) const {
+	std::call_once(table.built, [&]() {
+		// Reducing exponents modulo the group order is only sound if it is the order of the base
+		if (this->groupOrder > 0 && base.pow_mod(this->groupOrder, this->modulus) == 1)
+			table.exp.reset(new FixedBaseExp(base, this->modulus, this->groupOrder));
+	});
+	if (!table.exp || table.exp->getBase() != base || table.exp->getModulus() != this->modulus)
+		return nullptr;
+	return table.exp.get();
+}
+
+Bignum IntegerGroupParams::gPow(const Bignum& x) const {
+	const FixedBaseExp* gExp = getTable(this->g, *gTable);
+	return gExp ? gExp->pow(x) : this->g.pow_mod(x, this->modulus);
+}
+
+Bignum IntegerGroupParams::hPow(const Bignum& y) const {
+	const FixedBaseExp* hExp = getTable(this->h, *hTable);
+	return hExp ? hExp->pow(y) : this->h.pow_mod(y, this->modulus);
+}
+
+Bignum IntegerGroupParams::ghPow(const Bignum& x, const Bignum& y) const {
+	const FixedBaseExp* gExp = getTable(this->g, *gTable);
+	const FixedBaseExp* hExp = getTable(this->h, *hTable);
+	if (gExp && hExp)
+		return FixedBaseExp::pow2(*gExp, x, *hExp, y);
+	return this->g.pow_mod(x, this->modulus).mul_mod(this->h.pow_mod(y, this->modulus), this->modulus);
+}
+
 } /* namespace libzerocoin */
@@ -14,6 +14,9 @@
 
 #include "libzerocoin/Zerocoin.h"
 
+#include <memory>
+#include <mutex>
+
 namespace libzerocoin {
 
 class IntegerGroupParams {
@@ -24,11 +27,26 @@ public:
 	**/
 	IntegerGroupParams();
 
+	// Copies start without tables of their own
+	IntegerGroupParams(const IntegerGroupParams& other);
+	IntegerGroupParams& operator=(const IntegerGroupParams& other);
+
 	/**
 	 * Generates a random group element
 	 * @return a random element in the group.
 	 */
     CBigNum randomElement() const;
+
+	/**
+	 * Exponentiations of the generators, using tables of their powers that are
+	 * built once, on first use. Falls back to CBigNum::pow_mod for groups of
+	 * unknown order and for generators changed after their table was built.
+	 * @return g^x, h^y and g^x * h^y modulo the group modulus
+	 */
+	CBigNum gPow(const CBigNum& x) const;
+	CBigNum hPow(const CBigNum& y) const;
+	CBigNum ghPow(const CBigNum& x, const CBigNum& y) const;
+
 	bool initialized;
 
 	/**
@@ -64,6 +82,18 @@ public:
 		READWRITE(groupOrder);
 	};
 
+private:
+	// The powers of one generator. exp stays null if the generator turned out
+	// not to have order groupOrder, so the check is not repeated.
+	struct FixedBaseTable {
+		std::once_flag built;
+		std::unique_ptr<const FixedBaseExp> exp;
+	};
+
+	const FixedBaseExp* getTable(const CBigNum& base, FixedBaseTable& table) const;
+
+	std::unique_ptr<FixedBaseTable> gTable;
+	std::unique_ptr<FixedBaseTable> hTable;
 };
 
 class AccumulatorAndProofParams {
@@ -11,17 +11,28 @@
 **/
 
 #include "libzerocoin/Zerocoin.h"
-#include "libzerocoin/ParallelTasks.h"
+#include "../executor.h"
 
 namespace libzerocoin {
 
+// Runs func for every iteration of a proof, in chunks on the compute executor
+static void ForEachIteration(uint32_t nIterations, const std::function<void(uint32_t)>& func) {
+#ifdef ZEROCOIN_THREADING
+	GetComputeExecutor().ParallelFor(nIterations, [&func](size_t nBegin, size_t nEnd) {
+		for (size_t i = nBegin; i < nEnd; i++)
+			func(i);
+	});
+#else
+	for (uint32_t i = 0; i < nIterations; i++)
+		func(i);
+#endif
+}
+
 SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params* p): params(p) { }
 
 SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params* p, const PrivateCoin& coin, const Commitment& commitmentToCoin, uint256 msghash)
     :params(p), s_notprime(p->zkp_iterations), sprime(p->zkp_iterations) {
 
-    ParallelTasks::DoNotDisturb dnd;
-
 	// Sanity check: verify that the order of the "accumulatedValueCommitmentGroup" is
 	// equal to the modulus of "coinCommitmentGroup". Otherwise we will produce invalid
 	// proofs.
@@ -56,15 +67,10 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 	// instead we generate the random values beforehand and run the calculations
 	// based on those values in parallel.
 
-    ParallelTasks challenges(params->zkp_iterations);
-
-	for(uint32_t i=0; i < params->zkp_iterations; i++) {
+	ForEachIteration(params->zkp_iterations, [this, &coin, &c, &r, &v](uint32_t i) {
 		// compute g^{ {a^x b^r} h^v} mod p2
-        challenges.Add([this, i, &coin, &c, &r, &v] {
-            c[i] = challengeCalculation(coin.getSerialNumber(), r[i], v[i]);
-        });
-	}
-    challenges.Wait();
+		c[i] = challengeCalculation(coin.getSerialNumber(), r[i], v[i]);
+	});
 
 	// We can't hash data in parallel either
 	// because OPENMP cannot not guarantee loops
@@ -75,8 +81,7 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
     this->hash = hasher.GetArith256Hash();
 	unsigned char *hashbytes =  (unsigned char*) &hash;
 
-    challenges.Reset();
-	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
+	ForEachIteration(params->zkp_iterations, [this, hashbytes, &r, &v, &commitmentToCoin, &coin](uint32_t i) {
 		int bit = i % 8;
 		int byte = i / 8;
 
@@ -85,45 +90,36 @@ SerialNumberSignatureOfKnowledge::SerialNumberSignatureOfKnowledge(const Params*
 			s_notprime[i]       = r[i];
 			sprime[i]           = v[i];
 		} else {
-            challenges.Add([this, i, &r, &v, &b, &commitmentToCoin, &coin] {
-                s_notprime[i]   = r[i] - coin.getRandomness();
-                sprime[i]       = v[i] - (commitmentToCoin.getRandomness() *
-			                              b.pow_mod(r[i] - coin.getRandomness(), params->serialNumberSoKCommitmentGroup.groupOrder));
-            });
+			s_notprime[i]       = r[i] - coin.getRandomness();
+			sprime[i]           = v[i] - (commitmentToCoin.getRandomness() *
+			                              params->coinCommitmentGroup.hPow(r[i] - coin.getRandomness()));
 		}
-    }
-    challenges.Wait();
+	});
 }
 
 inline Bignum SerialNumberSignatureOfKnowledge::challengeCalculation(const Bignum& a_exp,const Bignum& b_exp,
         const Bignum& h_exp) const {
 
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
-
-	Bignum exponent = (a.pow_mod(a_exp, params->serialNumberSoKCommitmentGroup.groupOrder)
-	                   * b.pow_mod(b_exp, params->serialNumberSoKCommitmentGroup.groupOrder)) % params->serialNumberSoKCommitmentGroup.groupOrder;
+	// a^a_exp * b^b_exp mod serialNumberSoKCommitmentGroup.groupOrder, which is the modulus
+	// of coinCommitmentGroup, followed by g^exponent * h^h_exp, both from precomputed powers
+	Bignum exponent = params->coinCommitmentGroup.ghPow(a_exp, b_exp);
 
-	return (g.pow_mod(exponent, params->serialNumberSoKCommitmentGroup.modulus) * h.pow_mod(h_exp, params->serialNumberSoKCommitmentGroup.modulus)) % params->serialNumberSoKCommitmentGroup.modulus;
+	return params->serialNumberSoKCommitmentGroup.ghPow(exponent, h_exp);
 }
 
 bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, const Bignum& valueOfCommitmentToCoin,
         const uint256 msghash) const {
 
-    ParallelTasks::DoNotDisturb dnd;
-
-	Bignum a = params->coinCommitmentGroup.g;
-	Bignum b = params->coinCommitmentGroup.h;
-	Bignum g = params->serialNumberSoKCommitmentGroup.g;
-	Bignum h = params->serialNumberSoKCommitmentGroup.h;
-
 	// Make sure that the serial number has a unique representation
 	if (coinSerialNumber < 0 || coinSerialNumber >= params->coinCommitmentGroup.groupOrder){
 		return false;
 	}
 
+	// The prover refuses to work with such groups, see the constructor
+	if (params->coinCommitmentGroup.modulus != params->serialNumberSoKCommitmentGroup.groupOrder) {
+		return false;
+	}
+
 
 	CHashWriter hasher(0,0);
 	hasher << *params << valueOfCommitmentToCoin <<coinSerialNumber;
@@ -133,24 +129,18 @@ bool SerialNumberSignatureOfKnowledge::Verify(const Bignum& coinSerialNumber, co
 	vector<CBigNum> tprime(params->zkp_iterations);
 	unsigned char *hashbytes = (unsigned char*) &this->hash;
 
-    ParallelTasks challenges(params->zkp_iterations);
-
-	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
-        challenges.Add([this, i, hashbytes, &b, &h, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin] {
-            int bit = i % 8;
-            int byte = i / 8;
-            bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
-            if(challenge_bit) {
-                tprime[i] = challengeCalculation(coinSerialNumber, s_notprime[i], sprime[i]);
-            } else {
-                Bignum exp = b.pow_mod(s_notprime[i], params->serialNumberSoKCommitmentGroup.groupOrder);
-                tprime[i] = ((valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus) *
-                             (h.pow_mod(sprime[i], params->serialNumberSoKCommitmentGroup.modulus) % params->serialNumberSoKCommitmentGroup.modulus)) %
-                            params->serialNumberSoKCommitmentGroup.modulus;
-            }
-        });
-	}
-    challenges.Wait();
+	ForEachIteration(params->zkp_iterations, [this, hashbytes, &tprime, &coinSerialNumber, &valueOfCommitmentToCoin](uint32_t i) {
+		int bit = i % 8;
+		int byte = i / 8;
+		bool challenge_bit = ((hashbytes[byte] >> bit) & 0x01);
+		if(challenge_bit) {
+			tprime[i] = challengeCalculation(coinSerialNumber, s_notprime[i], sprime[i]);
+		} else {
+			Bignum exp = params->coinCommitmentGroup.hPow(s_notprime[i]);
+			tprime[i] = valueOfCommitmentToCoin.pow_mod(exp, params->serialNumberSoKCommitmentGroup.modulus).mul_mod(
+			            params->serialNumberSoKCommitmentGroup.hPow(sprime[i]), params->serialNumberSoKCommitmentGroup.modulus);
+		}
+	});
 
 	for(uint32_t i = 0; i < params->zkp_iterations; i++) {
 		hasher << tprime[i];
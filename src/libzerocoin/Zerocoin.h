@@ -61,6 +61,7 @@ namespace libzerocoin {
 
 #include "../serialize.h"
 #include "libzerocoin/bignum.h"
+#include "libzerocoin/FixedBaseExp.h"
 #include "../hash.h"
 #include "libzerocoin/Params.h"
 #include "libzerocoin/Coin.h"
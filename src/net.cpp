@@ -27,6 +27,10 @@
 #include <fcntl.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -36,6 +40,7 @@
 
 
 #include <math.h>
+#include <unordered_map>
 
 // Dump addresses to peers.dat and banlist.dat every 15 minutes (900s)
 #define DUMP_ADDRESSES_INTERVAL 900
@@ -43,6 +48,16 @@
 // We add a random period time (0 to 1 seconds) to feeler connections to prevent synchronization.
 #define FEELER_SLEEP_WINDOW 1
 
+// How long the socket handler waits for readiness before polling pnode->vSend again
+static const int SOCKET_EVENTS_TIMEOUT_MILLISECONDS = 50;
+
+#ifdef USE_EPOLL
+// Readiness events collected per epoll_wait; the rest stay queued for the next call
+static const int MAX_EPOLL_EVENTS = 512;
+// Tag in epoll_event.data marking a listen socket rather than a NodeId
+static const uint64_t EPOLL_LISTEN_SOCKET = 1ULL << 63;
+#endif
+
 #if !defined(HAVE_MSG_NOSIGNAL)
 #define MSG_NOSIGNAL 0
 #endif
@@ -449,6 +464,11 @@ CNode* CConnman::ConnectNode(CAddress addrConnect, const char *pszDest, bool fCo
         CloseSocket(hSocket);
         return nullptr;
     }
+    if (!IsWatchableSocket(hSocket)) {
+        LogPrintf("Cannot create connection: non-selectable socket created (fd >= FD_SETSIZE ?)\n");
+        CloseSocket(hSocket);
+        return nullptr;
+    }
 
     // Add node
     NodeId id = GetNewNodeId();
@@ -879,10 +899,12 @@ const uint256& CNetMessage::GetMessageHash() const
 
 
 // requires LOCK(cs_vSend)
-size_t CConnman::SocketSendData(CNode *pnode) const
+size_t CConnman::SocketSendData(CNode *pnode, bool *pfWouldBlock) const
 {
     auto it = pnode->vSendMsg.begin();
     size_t nSentSize = 0;
+    if (pfWouldBlock)
+        *pfWouldBlock = false;
 
     while (it != pnode->vSendMsg.end()) {
         const auto &data = *it;
@@ -906,6 +928,8 @@ size_t CConnman::SocketSendData(CNode *pnode) const
                 it++;
             } else {
                 // could not send full message; stop sending more
+                if (pfWouldBlock)
+                    *pfWouldBlock = true;
                 break;
             }
         } else {
@@ -917,6 +941,8 @@ size_t CConnman::SocketSendData(CNode *pnode) const
                     LogPrintf("socket send error %s\n", NetworkErrorString(nErr));
                     pnode->CloseSocketDisconnect();
                 }
+                if (nErr == WSAEWOULDBLOCK && pfWouldBlock)
+                    *pfWouldBlock = true;
             }
             // couldn't send anything at all
             break;
@@ -1104,7 +1130,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
         return;
     }
 
-    if (!IsSelectableSocket(hSocket))
+    if (!IsWatchableSocket(hSocket))
     {
         LogPrintf("connection from %s dropped: non-selectable socket\n", addr.ToString());
         CloseSocket(hSocket);
@@ -1149,6 +1175,291 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
     }
 }
 
+bool ParseSocketEventsMode(const std::string& strMode, SocketEventsMode& mode)
+{
+    if (strMode == "select") {
+        mode = SOCKETEVENTS_SELECT;
+        return true;
+    }
+#ifdef USE_EPOLL
+    if (strMode == "epoll") {
+        mode = SOCKETEVENTS_EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string GetSocketEventsModeName(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT: return "select";
+    case SOCKETEVENTS_EPOLL: return "epoll";
+    }
+    return "unknown";
+}
+
+bool CConnman::IsWatchableSocket(const SOCKET& hSocket) const
+{
+#ifndef WIN32
+    // fd_set can only hold descriptors below FD_SETSIZE
+    if (socketEventsMode == SOCKETEVENTS_SELECT)
+        return hSocket < FD_SETSIZE;
+#endif
+    return true;
+}
+
+bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        recv_set.insert(hListenSocket.socket);
+    }
+
+    {
+        LOCK(cs_vNodes);
+        for (CNode* pnode : vNodes)
+        {
+            // Implement the following logic:
+            // * If there is data to send, select() for sending data. As this only
+            //   happens when optimistic write failed, we choose to first drain the
+            //   write buffer in this case before receiving more. This avoids
+            //   needlessly queueing received data, if the remote peer is not themselves
+            //   receiving data. This means properly utilizing TCP flow control signalling.
+            // * Otherwise, if there is space left in the receive buffer, select() for
+            //   receiving data.
+            // * Hand off all complete messages to the processor, to be handled without
+            //   blocking here.
+
+            bool select_recv = !pnode->fPauseRecv;
+            bool select_send;
+            {
+                LOCK(pnode->cs_vSend);
+                select_send = !pnode->vSendMsg.empty();
+            }
+
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                continue;
+
+            error_set.insert(pnode->hSocket);
+            if (select_send) {
+                send_set.insert(pnode->hSocket);
+                continue;
+            }
+            if (select_recv) {
+                recv_set.insert(pnode->hSocket);
+            }
+        }
+    }
+
+    return !recv_set.empty() || !send_set.empty() || !error_set.empty();
+}
+
+void CConnman::SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
+    bool have_fds = GenerateSelectSet(recv_select_set, send_select_set, error_select_set);
+
+    //
+    // Find which sockets have data to receive
+    //
+    struct timeval timeout;
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = SOCKET_EVENTS_TIMEOUT_MILLISECONDS * 1000; // frequency to poll pnode->vSend
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+
+    for (SOCKET hSocket : recv_select_set) {
+        FD_SET(hSocket, &fdsetRecv);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+    for (SOCKET hSocket : send_select_set) {
+        FD_SET(hSocket, &fdsetSend);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+    for (SOCKET hSocket : error_select_set) {
+        FD_SET(hSocket, &fdsetError);
+        hSocketMax = std::max(hSocketMax, hSocket);
+    }
+
+    int nSelect = select(have_fds ? hSocketMax + 1 : 0,
+                         &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    if (interruptNet)
+        return;
+
+    if (nSelect == SOCKET_ERROR)
+    {
+        if (have_fds)
+        {
+            int nErr = WSAGetLastError();
+            LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
+            for (unsigned int i = 0; i <= hSocketMax; i++)
+                FD_SET(i, &fdsetRecv);
+        }
+        FD_ZERO(&fdsetSend);
+        FD_ZERO(&fdsetError);
+        if (!interruptNet.sleep_for(std::chrono::milliseconds(SOCKET_EVENTS_TIMEOUT_MILLISECONDS)))
+            return;
+    }
+
+    for (SOCKET hSocket : recv_select_set) {
+        if (FD_ISSET(hSocket, &fdsetRecv))
+            recv_set.insert(hSocket);
+    }
+    for (SOCKET hSocket : send_select_set) {
+        if (FD_ISSET(hSocket, &fdsetSend))
+            send_set.insert(hSocket);
+    }
+    for (SOCKET hSocket : error_select_set) {
+        if (FD_ISSET(hSocket, &fdsetError))
+            error_set.insert(hSocket);
+    }
+}
+
+#ifdef USE_EPOLL
+bool CConnman::InitSocketEventsEpoll()
+{
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollfd == -1) {
+        LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(WSAGetLastError()));
+        return false;
+    }
+
+    // Listen sockets stay level-triggered: AcceptConnection takes a single
+    // connection per wakeup and relies on being told again about the rest.
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = EPOLL_LISTEN_SOCKET | hListenSocket.socket;
+        if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hListenSocket.socket, &event) == -1) {
+            LogPrintf("epoll_ctl failed for listen socket: %s\n", NetworkErrorString(WSAGetLastError()));
+            close(epollfd);
+            epollfd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CConnman::SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    // Peer sockets are registered once for both directions with EPOLLET, so
+    // the kernel only reports transitions. Each node remembers whether its
+    // socket is readable or writable until a recv or send would block, and
+    // the same interest rules as select() are applied to that state: drain
+    // the send queue first, and leave paused receivers alone.
+    auto AddReadyNode = [&](CNode* pnode) {
+        bool fSendPending;
+        {
+            LOCK(pnode->cs_vSend);
+            fSendPending = !pnode->vSendMsg.empty();
+        }
+
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            return;
+        if (fSendPending) {
+            if (pnode->fSocketSendReady)
+                send_set.insert(pnode->hSocket);
+        } else if (pnode->fSocketRecvReady && !pnode->fPauseRecv) {
+            recv_set.insert(pnode->hSocket);
+        }
+    };
+
+    // Nodes are only deleted by this thread, so the pointers stay valid
+    // until the next call. Events are matched by NodeId rather than by
+    // descriptor, which may already have been reused.
+    std::unordered_map<NodeId, CNode*> mapNodes;
+    {
+        LOCK(cs_vNodes);
+        mapNodes.reserve(vNodes.size());
+        for (CNode* pnode : vNodes)
+        {
+            {
+                LOCK(pnode->cs_hSocket);
+                if (pnode->hSocket == INVALID_SOCKET)
+                    continue;
+                if (!pnode->fSocketRegistered) {
+                    struct epoll_event event = {};
+                    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    event.data.u64 = pnode->GetId();
+                    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, pnode->hSocket, &event) == -1) {
+                        LogPrintf("epoll_ctl failed for peer=%d: %s\n", pnode->GetId(), NetworkErrorString(WSAGetLastError()));
+                        pnode->fDisconnect = true;
+                        continue;
+                    }
+                    pnode->fSocketRegistered = true;
+                }
+            }
+            mapNodes.emplace(pnode->GetId(), pnode);
+            AddReadyNode(pnode);
+        }
+    }
+
+    // Don't block while known-ready sockets are waiting to be serviced
+    int nTimeout = (recv_set.empty() && send_set.empty()) ? SOCKET_EVENTS_TIMEOUT_MILLISECONDS : 0;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int nEvents = epoll_wait(epollfd, events, MAX_EPOLL_EVENTS, nTimeout);
+    if (interruptNet)
+        return;
+
+    if (nEvents == -1)
+    {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR) {
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(nErr));
+            interruptNet.sleep_for(std::chrono::milliseconds(SOCKET_EVENTS_TIMEOUT_MILLISECONDS));
+        }
+        return;
+    }
+
+    for (int i = 0; i < nEvents; i++)
+    {
+        const struct epoll_event& event = events[i];
+        if (event.data.u64 & EPOLL_LISTEN_SOCKET) {
+            recv_set.insert((SOCKET)(event.data.u64 & ~EPOLL_LISTEN_SOCKET));
+            continue;
+        }
+
+        auto it = mapNodes.find((NodeId)event.data.u64);
+        if (it == mapNodes.end())
+            continue;
+        CNode* pnode = it->second;
+
+        if (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            pnode->fSocketRecvReady = true;
+        if (event.events & EPOLLOUT)
+            pnode->fSocketSendReady = true;
+        if (event.events & (EPOLLHUP | EPOLLERR)) {
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket != INVALID_SOCKET)
+                error_set.insert(pnode->hSocket);
+        }
+        AddReadyNode(pnode);
+    }
+}
+#endif
+
+void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    switch (socketEventsMode) {
+#ifdef USE_EPOLL
+    case SOCKETEVENTS_EPOLL:
+        SocketEventsEpoll(recv_set, send_set, error_set);
+        break;
+#endif
+    default:
+        SocketEventsSelect(recv_set, send_set, error_set);
+        break;
+    }
+}
+
 void CConnman::ThreadSocketHandler()
 {
     unsigned int nPrevNodeCount = 0;
@@ -1215,94 +1526,18 @@ void CConnman::ThreadSocketHandler()
                 clientInterface->NotifyNumConnectionsChanged(nPrevNodeCount);
         }
 
-        //
-        // Find which sockets have data to receive
-        //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        for (const ListenSocket& hListenSocket : vhListenSocket) {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = std::max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
-        }
-
-        {
-            LOCK(cs_vNodes);
-            for (CNode* pnode : vNodes)
-            {
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is space left in the receive buffer, select() for
-                //   receiving data.
-                // * Hand off all complete messages to the processor, to be handled without
-                //   blocking here.
-
-                bool select_recv = !pnode->fPauseRecv;
-                bool select_send;
-                {
-                    LOCK(pnode->cs_vSend);
-                    select_send = !pnode->vSendMsg.empty();
-                }
-
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = std::max(hSocketMax, pnode->hSocket);
-                have_fds = true;
+        std::set<SOCKET> recv_set, send_set, error_set;
+        SocketEvents(recv_set, send_set, error_set);
 
-                if (select_send) {
-                    FD_SET(pnode->hSocket, &fdsetSend);
-                    continue;
-                }
-                if (select_recv) {
-                    FD_SET(pnode->hSocket, &fdsetRecv);
-                }
-            }
-        }
-
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
         if (interruptNet)
             return;
 
-        if (nSelect == SOCKET_ERROR)
-        {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            if (!interruptNet.sleep_for(std::chrono::milliseconds(timeout.tv_usec/1000)))
-                return;
-        }
-
         //
         // Accept new connections
         //
         for (const ListenSocket& hListenSocket : vhListenSocket)
         {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+            if (hListenSocket.socket != INVALID_SOCKET && recv_set.count(hListenSocket.socket) > 0)
             {
                 AcceptConnection(hListenSocket);
             }
@@ -1333,9 +1568,9 @@ void CConnman::ThreadSocketHandler()
                 LOCK(pnode->cs_hSocket);
                 if (pnode->hSocket == INVALID_SOCKET)
                     continue;
-                recvSet = FD_ISSET(pnode->hSocket, &fdsetRecv);
-                sendSet = FD_ISSET(pnode->hSocket, &fdsetSend);
-                errorSet = FD_ISSET(pnode->hSocket, &fdsetError);
+                recvSet = recv_set.count(pnode->hSocket) > 0;
+                sendSet = send_set.count(pnode->hSocket) > 0;
+                errorSet = error_set.count(pnode->hSocket) > 0;
             }
             if (recvSet || errorSet)
             {
@@ -1348,6 +1583,9 @@ void CConnman::ThreadSocketHandler()
                         continue;
                     nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
                 }
+                // A short read means the kernel buffer was drained, so wait
+                // for the next edge before reading again.
+                pnode->fSocketRecvReady = nBytes == sizeof(pchBuf) || (nBytes < 0 && WSAGetLastError() != WSAEWOULDBLOCK);
                 if (nBytes > 0)
                 {
                     bool notify = false;
@@ -1398,10 +1636,15 @@ void CConnman::ThreadSocketHandler()
             if (sendSet)
             {
                 LOCK(pnode->cs_vSend);
-                size_t nBytes = SocketSendData(pnode);
+                bool fWouldBlock;
+                size_t nBytes = SocketSendData(pnode, &fWouldBlock);
                 if (nBytes) {
                     RecordBytesSent(nBytes);
                 }
+                // Only a full socket buffer is followed by another edge, other
+                // errors are retried on the next pass
+                if (fWouldBlock)
+                    pnode->fSocketSendReady = false;
             }
 
             //
@@ -2204,6 +2447,9 @@ CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : nSeed0(nSeed0In), nSe
     nReceiveFloodSize = 0;
     flagInterruptMsgProc = false;
     SetTryNewOutboundPeer(false);
+#ifdef USE_EPOLL
+    epollfd = -1;
+#endif
 
     cPeerBlockCounts.set(5, 0);
 
@@ -2337,6 +2583,14 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         fMsgProcWake = false;
     }
 
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL && !InitSocketEventsEpoll()) {
+        LogPrintf("Falling back to select() for socket events\n");
+        socketEventsMode = SOCKETEVENTS_SELECT;
+    }
+#endif
+    LogPrintf("Using %s for socket events\n", GetSocketEventsModeName(socketEventsMode));
+
     // Send and receive from sockets, accept connections
     threadSocketHandler = std::thread(&TraceThread<std::function<void()> >, "net", std::function<void()>(std::bind(&CConnman::ThreadSocketHandler, this)));
 
@@ -2419,6 +2673,12 @@ void CConnman::Stop()
         threadDNSAddressSeed.join();
     if (threadSocketHandler.joinable())
         threadSocketHandler.join();
+#ifdef USE_EPOLL
+    if (epollfd != -1) {
+        close(epollfd);
+        epollfd = -1;
+    }
+#endif
 
     if (fAddressesInitialized)
     {
@@ -2745,6 +3005,9 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nextSendTimeFeeFilter = 0;
     fPauseRecv = false;
     fPauseSend = false;
+    fSocketRegistered = false;
+    fSocketRecvReady = false;
+    fSocketSendReady = false;
     nProcessQueueSize = 0;
     //Ghostnode
     fGhostnode = false;
@@ -24,6 +24,7 @@
 
 #include <atomic>
 #include <deque>
+#include <set>
 #include <stdint.h>
 #include <thread>
 #include <memory>
@@ -89,6 +90,22 @@ static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Defaul
 
 typedef int64_t NodeId;
 
+/** How the socket handler thread waits for readiness on peer sockets */
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT = 0,
+    SOCKETEVENTS_EPOLL = 1,
+};
+
+#ifdef USE_EPOLL
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_EPOLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_SELECT;
+#endif
+
+/** Parse a -socketevents value. Returns false for unknown modes and modes not built in. */
+bool ParseSocketEventsMode(const std::string& strMode, SocketEventsMode& mode);
+std::string GetSocketEventsModeName(SocketEventsMode mode);
+
 struct AddedNodeInfo
 {
     std::string strAddedNode;
@@ -145,6 +162,7 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
     };
 
     void Init(const Options& connOptions) {
@@ -168,6 +186,7 @@ public:
             LOCK(cs_vAddedNodes);
             vAddedNodes = connOptions.m_added_nodes;
         }
+        socketEventsMode = connOptions.socketEventsMode;
     }
 
     CConnman(uint64_t seed0, uint64_t seed1);
@@ -343,6 +362,14 @@ private:
     void ThreadOpenConnections(std::vector<std::string> connect);
     void ThreadMessageHandler();
     void AcceptConnection(const ListenSocket& hListenSocket);
+    bool IsWatchableSocket(const SOCKET& hSocket) const;
+    bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+    void SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#ifdef USE_EPOLL
+    bool InitSocketEventsEpoll();
+    void SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+    void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
@@ -355,7 +382,8 @@ private:
 
     NodeId GetNewNodeId();
 
-    size_t SocketSendData(CNode *pnode) const;
+    // Sets *pfWouldBlock if it stopped because the socket can't take more data right now
+    size_t SocketSendData(CNode *pnode, bool *pfWouldBlock = nullptr) const;
     //!check is the banlist has unwritten changes
     bool BannedSetIsDirty();
     //!set the "dirty" flag for the banlist
@@ -394,6 +422,13 @@ private:
 
     std::vector<ListenSocket> vhListenSocket;
     std::atomic<bool> fNetworkActive;
+
+    /** Readiness backend of the socket handler thread */
+    SocketEventsMode socketEventsMode;
+#ifdef USE_EPOLL
+    /** Edge-triggered epoll instance watching the listen and peer sockets, or -1 */
+    int epollfd;
+#endif
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
     bool setBannedIsDirty;
@@ -685,6 +720,11 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv;
     std::atomic_bool fPauseSend;
+    // Edge-triggered readiness of hSocket, only used by the socket handler
+    // thread in epoll mode. Cleared once a recv or send would block.
+    bool fSocketRegistered;
+    bool fSocketRecvReady;
+    bool fSocketSendReady;
 protected:
 
     mapMsgCmdSize mapSendBytesPerMsgCmd;
@@ -19,6 +19,7 @@
 #include <policy/policy.h>
 #include <consensus/validation.h>
 #include <coins.h>
+#include <executor.h>
 
 /**
  * Stake Modifier (hash modifier of proof-of-stake):
@@ -366,3 +367,87 @@ bool CheckKernel(const CBlockIndex *pindexPrev, unsigned int nBits, int64_t nTim
         amount, prevout, nTime, hashProofOfStake, targetProofOfStake);
 }
 
+void CStakeKernelCache::Update(const CBlockIndex *pindexPrev, unsigned int nBitsIn, const std::vector<COutPoint> &vPrevoutsIn)
+{
+    if (pindexPrev->GetBlockHash() == hashPrevBlock && nBitsIn == nBits && vPrevoutsIn == vPrevouts)
+        return;
+
+    hashPrevBlock = pindexPrev->GetBlockHash();
+    nBits = nBitsIn;
+    vPrevouts = vPrevoutsIn;
+    vCandidates.clear();
+
+    arith_uint256 bnTarget;
+    bool fNegative;
+    bool fOverflow;
+    bnTarget.SetCompact(nBits, &fNegative, &fOverflow);
+    if (fNegative || fOverflow || bnTarget == 0)
+        return;
+
+    LOCK(cs_main);
+    int coinbaseMaturity = chainActive.Height() >= Params().GetConsensus().nCoinMaturityReductionHeight ?
+                COINBASE_MATURITY_V2 : COINBASE_MATURITY;
+
+    bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET || Params().NetworkIDString() == CBaseChainParams::REGTEST);
+    if(fTestNet)
+        coinbaseMaturity = COINBASE_MATURITY_TESTNET;
+
+    int nRequiredDepth = (int)(coinbaseMaturity-1);
+
+    vCandidates.reserve(vPrevouts.size());
+    for (size_t i = 0; i < vPrevouts.size(); i++) {
+        const COutPoint &prevout = vPrevouts[i];
+        Coin coin;
+        if (!pcoinsTip->GetCoin(prevout, coin) || coin.IsSpent())
+            continue;
+
+        CBlockIndex *pindex = chainActive[coin.nHeight];
+        if (!pindex || nRequiredDepth > pindexPrev->nHeight - coin.nHeight)
+            continue;
+
+        CKernelCandidate candidate;
+        candidate.nIndex = i;
+        candidate.nBlockFromTime = pindex->GetBlockTime();
+        candidate.bnTarget = bnTarget * arith_uint256(coin.out.nValue);
+
+        // Same preimage as CheckStakeKernelHash
+        CDataStream ss(SER_GETHASH, 0);
+        ss << pindexPrev->bnStakeModifier;
+        ss << candidate.nBlockFromTime << prevout.hash << prevout.n;
+        candidate.hasher.Write((const unsigned char*)ss.data(), ss.size());
+        vCandidates.push_back(candidate);
+    }
+}
+
+void CStakeKernelCache::Search(uint32_t nTime, std::vector<bool> &vFound) const
+{
+    vFound.assign(vPrevouts.size(), false);
+
+    unsigned char timeBytes[4];
+    WriteLE32(timeBytes, nTime);
+
+    // vector<bool> packs bits, so matches are gathered per chunk and merged afterwards
+    std::mutex csFound;
+    GetComputeExecutor().ParallelFor(vCandidates.size(), [&](size_t nBegin, size_t nEnd) {
+        std::vector<size_t> vMatches;
+        for (size_t i = nBegin; i < nEnd; i++) {
+            const CKernelCandidate &candidate = vCandidates[i];
+            if (nTime < candidate.nBlockFromTime)
+                continue;
+
+            uint256 hashProofOfStake;
+            CSHA256 hasher(candidate.hasher);
+            hasher.Write(timeBytes, sizeof(timeBytes)).Finalize(hashProofOfStake.begin());
+            CSHA256().Write(hashProofOfStake.begin(), 32).Finalize(hashProofOfStake.begin());
+
+            if (UintToArith256(hashProofOfStake) <= candidate.bnTarget)
+                vMatches.push_back(i);
+        }
+
+        if (vMatches.empty())
+            return;
+        std::lock_guard<std::mutex> lock(csFound);
+        for (size_t i : vMatches)
+            vFound[vCandidates[i].nIndex] = true;
+    });
+}
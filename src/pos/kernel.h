@@ -7,6 +7,10 @@
 #define PPCOIN_KERNEL_H
 
 #include <validation.h>
+#include <arith_uint256.h>
+#include <crypto/sha256.h>
+
+#include <vector>
 
 
 // Compute the hash modifier for proof-of-stake
@@ -41,4 +45,45 @@ bool CheckCoinStakeTimestamp(int nHeight, int64_t nTimeBlock);
  */
 bool CheckKernel(const CBlockIndex *pindexPrev, unsigned int nBits, int64_t nTime, const COutPoint &prevout, int64_t* pBlockTime = nullptr);
 
+/**
+ * Kernel search state of the stake miner for one chain tip and difficulty.
+ * For every candidate output it keeps the hasher of the kernel preimage up
+ * to the transaction time, and the target weighted by the output value, so
+ * testing a timestamp slot costs a single hash per output.
+ */
+class CStakeKernelCache
+{
+public:
+    CStakeKernelCache() : nBits(0) {}
+
+    /**
+     * Brings the cache up to date for the given tip, nBits and candidate
+     * outputs. Outputs that CheckKernel would reject for being missing,
+     * spent or too shallow are left out. Nothing is recomputed unless the
+     * tip, nBits or the candidates changed.
+     */
+    void Update(const CBlockIndex *pindexPrev, unsigned int nBits, const std::vector<COutPoint> &vPrevouts);
+
+    /**
+     * Checks the kernels of all candidates at nTime on the compute executor.
+     * Sets vFound, indexed like the candidates passed to Update, for the
+     * outputs that meet the target.
+     */
+    void Search(uint32_t nTime, std::vector<bool> &vFound) const;
+
+private:
+    struct CKernelCandidate {
+        size_t nIndex;
+        uint32_t nBlockFromTime;
+        arith_uint256 bnTarget;
+        // modifier, block time and prevout written, the transaction time follows
+        CSHA256 hasher;
+    };
+
+    uint256 hashPrevBlock;
+    unsigned int nBits;
+    std::vector<COutPoint> vPrevouts;
+    std::vector<CKernelCandidate> vCandidates;
+};
+
 #endif // PPCOIN_KERNEL_H
@@ -0,0 +1,81 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef NIX_PRIVACYSTATSINDEX_H
+#define NIX_PRIVACYSTATSINDEX_H
+
+#include "amount.h"
+#include "serialize.h"
+
+// Zerocoin denominations 1, 5, 10, 50, 100, 500, 1000 and 5000
+static const int PRIVACY_STATS_ZEROCOIN_DENOMS = 8;
+// Sigma denominations 0.1, 1, 10, 100, 1000 and 10000
+static const int PRIVACY_STATS_SIGMA_DENOMS = 6;
+
+static const CAmount PRIVACY_STATS_ZEROCOIN_VALUES[PRIVACY_STATS_ZEROCOIN_DENOMS] = {
+    1 * COIN, 5 * COIN, 10 * COIN, 50 * COIN, 100 * COIN, 500 * COIN, 1000 * COIN, 5000 * COIN
+};
+static const CAmount PRIVACY_STATS_SIGMA_VALUES[PRIVACY_STATS_SIGMA_DENOMS] = {
+    10 * CENT, 1 * COIN, 10 * COIN, 100 * COIN, 1000 * COIN, 10000 * COIN
+};
+
+// Totals over the active chain from the genesis block up to and including
+// the block at the indexed height. The totals of a height range are the
+// difference of the values at both ends.
+struct CPrivacyStatsIndexValue {
+    // Mint outputs and spend transaction outputs per denomination
+    uint64_t zerocoinMints[PRIVACY_STATS_ZEROCOIN_DENOMS];
+    uint64_t zerocoinSpends[PRIVACY_STATS_ZEROCOIN_DENOMS];
+    uint64_t sigmaMints[PRIVACY_STATS_SIGMA_DENOMS];
+    uint64_t sigmaSpends[PRIVACY_STATS_SIGMA_DENOMS];
+    // Value added to the ghost fee pool
+    CAmount ghostedValue;
+    // Value of the first output of the first transaction, the stake of PoS blocks
+    CAmount stakeValue;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        for (int i = 0; i < PRIVACY_STATS_ZEROCOIN_DENOMS; i++) {
+            READWRITE(VARINT(zerocoinMints[i]));
+            READWRITE(VARINT(zerocoinSpends[i]));
+        }
+        for (int i = 0; i < PRIVACY_STATS_SIGMA_DENOMS; i++) {
+            READWRITE(VARINT(sigmaMints[i]));
+            READWRITE(VARINT(sigmaSpends[i]));
+        }
+        READWRITE(ghostedValue);
+        READWRITE(stakeValue);
+    }
+
+    CPrivacyStatsIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        for (int i = 0; i < PRIVACY_STATS_ZEROCOIN_DENOMS; i++)
+            zerocoinMints[i] = zerocoinSpends[i] = 0;
+        for (int i = 0; i < PRIVACY_STATS_SIGMA_DENOMS; i++)
+            sigmaMints[i] = sigmaSpends[i] = 0;
+        ghostedValue = 0;
+        stakeValue = 0;
+    }
+
+    CPrivacyStatsIndexValue& operator-=(const CPrivacyStatsIndexValue& other) {
+        for (int i = 0; i < PRIVACY_STATS_ZEROCOIN_DENOMS; i++) {
+            zerocoinMints[i] -= other.zerocoinMints[i];
+            zerocoinSpends[i] -= other.zerocoinSpends[i];
+        }
+        for (int i = 0; i < PRIVACY_STATS_SIGMA_DENOMS; i++) {
+            sigmaMints[i] -= other.sigmaMints[i];
+            sigmaSpends[i] -= other.sigmaSpends[i];
+        }
+        ghostedValue -= other.ghostedValue;
+        stakeValue -= other.stakeValue;
+        return *this;
+    }
+};
+
+#endif // NIX_PRIVACYSTATSINDEX_H
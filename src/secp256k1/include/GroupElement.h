@@ -20,15 +20,16 @@ public:
 
   GroupElement();
 
-  ~GroupElement();
-
-  GroupElement(const GroupElement& other);
+  // The value is stored inline, so copies and moves are plain memory copies.
+  GroupElement(const GroupElement& other) = default;
+  GroupElement(GroupElement&& other) = default;
 
   GroupElement(const char* x,const char* y,  int base = 10);
 
   GroupElement& set(const GroupElement& other);
 
-  GroupElement& operator=(const GroupElement& other);
+  GroupElement& operator=(const GroupElement& other) = default;
+  GroupElement& operator=(GroupElement&& other) = default;
 
   // Operator for multiplying with a scalar number.
   GroupElement operator*(const Scalar& multiplier) const;
@@ -44,6 +45,17 @@ public:
 
   GroupElement inverse() const;
 
+  // Brings the element to affine representation (z = 1). The value is not
+  // changed, yet multi-exponentiations over it skip the field inversion.
+  GroupElement& normalize();
+
+  // Same as normalize() for all the elements, using a single field inversion.
+  static void normalize(std::vector<GroupElement>& points);
+
+  // Adds the same element to every point, using mixed additions, and returns
+  // the sums in affine representation.
+  static void add_to_all(std::vector<GroupElement>& points, const GroupElement& offset);
+
   void square();
 
   bool operator==(const GroupElement&other) const;
@@ -74,6 +86,13 @@ public:
   unsigned char* serialize(unsigned char* buffer) const;
   unsigned char* deserialize(unsigned char* buffer);
 
+  // Affine x and y followed by the infinity flag. Twice the size of the
+  // compressed form, but reading it back needs no square root. Reading throws
+  // std::invalid_argument if the buffer does not hold a point of the curve.
+  static constexpr std::size_t affine_size = 65;
+  unsigned char* serialize_affine(unsigned char* buffer) const;
+  const unsigned char* deserialize_affine(const unsigned char* buffer);
+
   // These functions are for READWRITE() in serialize.h
   unsigned int GetSerializeSize() const
   {
@@ -104,6 +123,7 @@ public:
   std::size_t hash() const;
 
   friend class MultiExponent;
+  friend class FixedBaseTables;
 private:
     // Returns the secp object inside it.
     const void * get_value() const;
@@ -111,7 +131,10 @@ private:
     GroupElement(const void *g);
 
 private:
-    void *g_; // secp256k1_gej
+    // Size of secp256k1_gej with either field implementation.
+    static constexpr std::size_t gej_size = 128;
+
+    alignas(8) unsigned char g_[gej_size]; // secp256k1_gej
 
 };
 
@@ -1,24 +1,46 @@
 #ifndef SECP_MULTIEXPONENT_H
 #define SECP_MULTIEXPONENT_H
 
+#include <memory>
 #include <vector>
 #include "GroupElement.h"
 #include "Scalar.h"
 
 namespace secp_primitives {
 
+// Window tables of a set of bases used over and over, like the generators of
+// the sigma parameters. The object that owns the bases owns the tables too.
+class FixedBaseTables final {
+public:
+    explicit FixedBaseTables(const std::vector<GroupElement>& bases);
+    ~FixedBaseTables();
+
+    // Returns true if the generators are the bases of the tables, or a prefix of them
+    bool covers(const std::vector<GroupElement>& generators) const;
+
+    // Defined along with the multi-exponentiation code
+    struct Tables;
+
+private:
+    friend class MultiExponent;
+    std::unique_ptr<const Tables> tables_;
+};
+
+// Computes the sum of generators[i] * powers[i]. The vectors are not copied and
+// must outlive the object. Each thread keeps its scratch memory between calls.
 class MultiExponent final {
 public:
-    MultiExponent(const MultiExponent& other);
-    MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers);
-    ~MultiExponent();
+    // If fixed_bases covers the generators its tables are used instead of
+    // building new ones.
+    MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers,
+                  const FixedBaseTables* fixed_bases = nullptr);
 
     GroupElement get_multiple();
 
 private:
-    void  *sc_; // secp256k1_scalar[]
-    void  *pt_; // secp256k1_gej[]
-    int n_points;
+    const std::vector<GroupElement>& generators_;
+    const std::vector<Scalar>& powers_;
+    const FixedBaseTables* fixed_bases_;
 };
 
 }// namespace secp_primitives
@@ -1,6 +1,7 @@
 #ifndef SCALAR_H__
 #define SCALAR_H__
 
+#include <cstring>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -14,20 +15,20 @@ namespace secp_primitives {
 class Scalar final {
 public:
 
-    Scalar();
+    Scalar() : value_() {}
     // Constructor from interger.
     Scalar(uint64_t value);
 
-    // Copy constructor
-    Scalar(const Scalar& other);
+    // The value is stored inline, so copies and moves are plain memory copies.
+    Scalar(const Scalar& other) = default;
+    Scalar(Scalar&& other) = default;
 
     Scalar(const unsigned char* str);
 
-    ~Scalar();
-
     Scalar& set(const Scalar& other);
 
-    Scalar& operator=(const Scalar& other);
+    Scalar& operator=(const Scalar& other) = default;
+    Scalar& operator=(Scalar&& other) = default;
 
     Scalar& operator=(unsigned int i);
 
@@ -45,8 +46,13 @@ public:
 
     Scalar& operator-=(const Scalar& other);
 
-    bool operator==(const Scalar& other) const;
-    bool operator!=(const Scalar& other) const;
+    // Scalars are always kept reduced, so equal values have equal limbs.
+    bool operator==(const Scalar& other) const {
+        return std::memcmp(value_, other.value_, scalar_size) == 0;
+    }
+    bool operator!=(const Scalar& other) const {
+        return !(*this == other);
+    }
 
     Scalar inverse() const;
 
@@ -87,7 +93,7 @@ public:
     unsigned char* deserialize(unsigned char* buffer);
 
     std::string GetHex() const;
-    void SetHex(const std::string& str) const;
+    void SetHex(const std::string& str);
 
     // These functions are for READWRITE() in serialize.h
 
@@ -121,7 +127,10 @@ private:
     Scalar(const void *value);
 
 private:
-    void *value_; // secp256k1_scalar
+    // Size of secp256k1_scalar with either scalar implementation.
+    static constexpr std::size_t scalar_size = 32;
+
+    alignas(8) unsigned char value_[scalar_size]; // secp256k1_scalar
 
 };
 
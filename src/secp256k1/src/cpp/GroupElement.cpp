@@ -159,22 +159,19 @@ static void _negate (uint8_t(&num) [Len])
     }
 }
 
+static_assert(sizeof(secp256k1_gej) <= sizeof(GroupElement), "GroupElement storage is too small for secp256k1_gej");
+static_assert(alignof(secp256k1_gej) <= alignof(GroupElement), "GroupElement storage is not aligned for secp256k1_gej");
+
 GroupElement::GroupElement()
-        : g_(new secp256k1_gej())
 {
     auto g = reinterpret_cast<secp256k1_gej *>(g_);
     secp256k1_gej_clear(g);
     g->infinity = 1;
 }
 
-GroupElement::GroupElement(const GroupElement& other)
-        : g_(new secp256k1_gej(*reinterpret_cast<secp256k1_gej *>(other.g_)))
-{
-}
-
 GroupElement::GroupElement(const void *g)
-        : g_(new secp256k1_gej(*reinterpret_cast<const secp256k1_gej *>(g)))
 {
+    *reinterpret_cast<secp256k1_gej *>(g_) = *reinterpret_cast<const secp256k1_gej *>(g);
 }
 
 static void _convertToFieldElement(secp256k1_fe *r, const char* str, int base) {
@@ -225,7 +222,6 @@ static void _convertToFieldElement(secp256k1_fe *r, const char* str, int base) {
 }
 
 GroupElement::GroupElement(const char* x,const char* y, int base)
-        : g_(new secp256k1_gej())
 {
     auto g = reinterpret_cast<secp256k1_gej *>(g_);
 
@@ -237,19 +233,9 @@ GroupElement::GroupElement(const char* x,const char* y, int base)
     secp256k1_gej_set_ge(g,&element);
 }
 
-GroupElement::~GroupElement()
-{
-    delete reinterpret_cast<secp256k1_gej *>(g_);
-}
-
-GroupElement& GroupElement::operator=(const GroupElement &other)
-{
-    return set(other);
-}
-
 GroupElement& GroupElement::set(const GroupElement &other)
 {
-    *reinterpret_cast<secp256k1_gej *>(g_) = *reinterpret_cast<secp256k1_gej *>(other.g_);
+    *reinterpret_cast<secp256k1_gej *>(g_) = *reinterpret_cast<const secp256k1_gej *>(other.g_);
     return *this;
 }
 
@@ -258,7 +244,7 @@ GroupElement GroupElement::operator*(const Scalar& multiplier) const
     secp256k1_gej result;
     secp256k1_scalar ng;
     secp256k1_scalar_set_int(&ng,0);
-    secp256k1_ecmult(&ctx,&result,reinterpret_cast<secp256k1_gej *>(g_), reinterpret_cast<const secp256k1_scalar *>(multiplier.get_value()),&ng);
+    secp256k1_ecmult(&ctx,&result,reinterpret_cast<const secp256k1_gej *>(g_), reinterpret_cast<const secp256k1_scalar *>(multiplier.get_value()),&ng);
     return &result;
 }
 
@@ -274,21 +260,79 @@ GroupElement& GroupElement::operator*=(const Scalar& multiplier)
 GroupElement GroupElement::operator+(const GroupElement &other) const
 {
     secp256k1_gej result_gej;
-    secp256k1_gej_add_var(&result_gej, reinterpret_cast<secp256k1_gej *>(g_), reinterpret_cast<secp256k1_gej *>(other.g_), NULL);
+    secp256k1_gej_add_var(&result_gej, reinterpret_cast<const secp256k1_gej *>(g_), reinterpret_cast<const secp256k1_gej *>(other.g_), NULL);
     return &result_gej;
 }
 
 GroupElement& GroupElement::operator+=(const GroupElement& other)
 {
     auto g = reinterpret_cast<secp256k1_gej *>(g_);
-    secp256k1_gej_add_var(g, g, reinterpret_cast<secp256k1_gej *>(other.g_), NULL);
+    secp256k1_gej_add_var(g, g, reinterpret_cast<const secp256k1_gej *>(other.g_), NULL);
+    return *this;
+}
+
+// Returns true when the element is already in affine representation.
+static bool gej_is_normalized(const secp256k1_gej &gej)
+{
+    static const secp256k1_fe one = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 1);
+    return gej.infinity || secp256k1_fe_equal_var(&one, &gej.z);
+}
+
+// Replaces the coordinates of all the non-normalized points by their affine
+// form, inverting all the z coordinates together.
+static void gej_normalize_all(const std::vector<secp256k1_gej *> &points)
+{
+    std::vector<secp256k1_gej *> pending;
+    std::vector<secp256k1_fe> z;
+    pending.reserve(points.size());
+    z.reserve(points.size());
+    for (secp256k1_gej *p : points) {
+        if (!gej_is_normalized(*p)) {
+            pending.push_back(p);
+            z.push_back(p->z);
+        }
+    }
+    if (pending.empty())
+        return;
+
+    std::vector<secp256k1_fe> zinv(z.size());
+    secp256k1_fe_inv_all_var(zinv.data(), z.data(), z.size());
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        secp256k1_ge ge;
+        secp256k1_ge_set_gej_zinv(&ge, pending[i], &zinv[i]);
+        secp256k1_gej_set_ge(pending[i], &ge);
+    }
+}
+
+GroupElement& GroupElement::normalize()
+{
+    gej_normalize_all({reinterpret_cast<secp256k1_gej *>(g_)});
     return *this;
 }
 
+void GroupElement::normalize(std::vector<GroupElement>& points)
+{
+    std::vector<secp256k1_gej *> gejs;
+    gejs.reserve(points.size());
+    for (GroupElement& p : points)
+        gejs.push_back(reinterpret_cast<secp256k1_gej *>(p.g_));
+    gej_normalize_all(gejs);
+}
+
+void GroupElement::add_to_all(std::vector<GroupElement>& points, const GroupElement& offset)
+{
+    secp256k1_ge offset_ge = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(offset.g_));
+    for (GroupElement& p : points) {
+        auto g = reinterpret_cast<secp256k1_gej *>(p.g_);
+        secp256k1_gej_add_ge_var(g, g, &offset_ge, NULL);
+    }
+    normalize(points);
+}
+
 GroupElement GroupElement::inverse() const
 {
     secp256k1_gej result_gej;
-    secp256k1_gej_neg(&result_gej,reinterpret_cast<secp256k1_gej *>(g_));
+    secp256k1_gej_neg(&result_gej,reinterpret_cast<const secp256k1_gej *>(g_));
     return &result_gej;
 }
 
@@ -300,21 +344,28 @@ void GroupElement::square()
 
 bool GroupElement::operator==(const  GroupElement& other) const
 {
-    auto g = reinterpret_cast<secp256k1_gej *>(g_);
-    auto og = reinterpret_cast<secp256k1_gej *>(other.g_);
+    auto g = reinterpret_cast<const secp256k1_gej *>(g_);
+    auto og = reinterpret_cast<const secp256k1_gej *>(other.g_);
 
     if(g->infinity && og->infinity)
         return true;
     if(g->infinity != og->infinity)
         return false;
-    secp256k1_ge this_ge = gej_to_ge(*g);
-    secp256k1_ge other_ge = gej_to_ge(*og);
-    if(!secp256k1_fe_equal(&this_ge.x, &other_ge.x))
-        return false;
-    if(!secp256k1_fe_equal(&this_ge.y, &other_ge.y))
-        return false;
 
-    return true;
+    // Compare x1 * z2^2 == x2 * z1^2 and y1 * z2^3 == y2 * z1^3, so no
+    // coordinates need to be inverted.
+    secp256k1_fe z1_2, z2_2, z1_3, z2_3, u1, u2, s1, s2;
+    secp256k1_fe_sqr(&z1_2, &g->z);
+    secp256k1_fe_sqr(&z2_2, &og->z);
+    secp256k1_fe_mul(&u1, &g->x, &z2_2);
+    secp256k1_fe_mul(&u2, &og->x, &z1_2);
+    if(!secp256k1_fe_equal_var(&u1, &u2))
+        return false;
+    secp256k1_fe_mul(&z1_3, &z1_2, &g->z);
+    secp256k1_fe_mul(&z2_3, &z2_2, &og->z);
+    secp256k1_fe_mul(&s1, &g->y, &z2_3);
+    secp256k1_fe_mul(&s2, &og->y, &z1_3);
+    return secp256k1_fe_equal_var(&s1, &s2);
 }
 
 bool GroupElement::operator!=(const  GroupElement& other) const
@@ -324,7 +375,7 @@ bool GroupElement::operator!=(const  GroupElement& other) const
 
 bool GroupElement::isMember() const
 {
-    secp256k1_ge v1 = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
+    secp256k1_ge v1 = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(g_));
     if (secp256k1_ge_is_infinity(&v1)) {
         return true;
     }
@@ -388,7 +439,7 @@ GroupElement& GroupElement::generate(unsigned char* seed){
 }
 
 void GroupElement::sha256(unsigned char* result) const{
-    auto g = reinterpret_cast<secp256k1_gej *>(g_);
+    auto g = reinterpret_cast<const secp256k1_gej *>(g_);
     unsigned char buff[64];
     secp256k1_fe_get_b32(&buff[0], &g->x);
     secp256k1_fe_get_b32(&buff[32], &g->y);
@@ -447,7 +498,7 @@ std::string _convertToString(const unsigned char(&buffer) [Len], int base) {
 
 std::string GroupElement::tostring() const {
     int base = 10;
-    secp256k1_ge ge = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
+    secp256k1_ge ge = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(g_));
 
     if (ge.infinity) {
     return std::string("O");
@@ -469,7 +520,7 @@ std::string GroupElement::tostring() const {
 
 std::string GroupElement::GetHex() const {
     int base = 16;
-    secp256k1_ge ge = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
+    secp256k1_ge ge = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(g_));
 
     if (ge.infinity) {
         return std::string("O");
@@ -495,7 +546,7 @@ size_t GroupElement::memoryRequired() const  {
 
 
 unsigned char* GroupElement::serialize() const {
-    auto g = reinterpret_cast<secp256k1_gej *>(g_);
+    auto g = reinterpret_cast<const secp256k1_gej *>(g_);
     unsigned char* data = new unsigned char[ 2 * sizeof(secp256k1_fe)];
     memcpy(&data[0], &g->x.n[0], sizeof(secp256k1_fe));
     memcpy(&data[0] + sizeof(secp256k1_fe), &g->y.n[0], sizeof(secp256k1_fe));
@@ -503,7 +554,7 @@ unsigned char* GroupElement::serialize() const {
 }
 
 unsigned char* GroupElement::serialize(unsigned char* buffer) const {
-    secp256k1_ge value = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
+    secp256k1_ge value = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(g_));
     secp256k1_fe x = value.x;
     secp256k1_fe y = value.y;
     secp256k1_fe_normalize(&x);
@@ -528,6 +579,31 @@ unsigned char* GroupElement::deserialize(unsigned char* buffer) {
     return buffer + memoryRequired();
 }
 
+unsigned char* GroupElement::serialize_affine(unsigned char* buffer) const {
+    secp256k1_ge value = gej_to_ge(*reinterpret_cast<const secp256k1_gej *>(g_));
+    secp256k1_fe_normalize(&value.x);
+    secp256k1_fe_normalize(&value.y);
+    secp256k1_fe_get_b32(buffer, &value.x);
+    secp256k1_fe_get_b32(buffer + 32, &value.y);
+    buffer[64] = value.infinity;
+    return buffer + affine_size;
+}
+
+const unsigned char* GroupElement::deserialize_affine(const unsigned char* buffer) {
+    secp256k1_fe x, y;
+    if (!secp256k1_fe_set_b32(&x, buffer) || !secp256k1_fe_set_b32(&y, buffer + 32))
+        throw std::invalid_argument("GroupElement::deserialize_affine: coordinate overflow");
+    if (buffer[64] > 1)
+        throw std::invalid_argument("GroupElement::deserialize_affine: invalid infinity flag");
+    secp256k1_ge result;
+    secp256k1_ge_set_xy(&result, &x, &y);
+    result.infinity = (int)buffer[64];
+    if (!result.infinity && !secp256k1_ge_is_valid_var(&result))
+        throw std::invalid_argument("GroupElement::deserialize_affine: point is not on the curve");
+    secp256k1_gej_set_ge(reinterpret_cast<secp256k1_gej *>(g_), &result);
+    return buffer + affine_size;
+}
+
 std::vector<unsigned char> GroupElement::getvch() const {
     unsigned char buffer[memoryRequired()];
     serialize(buffer);
@@ -538,17 +614,32 @@ std::vector<unsigned char> GroupElement::getvch() const {
 
 std::size_t GroupElement::hash() const
 {
-    auto ge = gej_to_ge(*reinterpret_cast<secp256k1_gej *>(g_));
-    std::array<unsigned char, 32 * 2> coord;
-
-    if (ge.infinity) {
-        coord.fill(0);
+    auto g = reinterpret_cast<const secp256k1_gej *>(g_);
+    if (g->infinity)
+        return 0;
+
+    // Elements read from their serialized form, or normalized, are already
+    // affine and need no inversion here.
+    secp256k1_fe x, y;
+    if (gej_is_normalized(*g)) {
+        x = g->x;
+        y = g->y;
     } else {
-        secp256k1_fe_get_b32(&coord[0], &ge.x);
-        secp256k1_fe_get_b32(&coord[32], &ge.y);
+        secp256k1_ge ge = gej_to_ge(*g);
+        x = ge.x;
+        y = ge.y;
     }
+    secp256k1_fe_normalize_var(&x);
+    secp256k1_fe_normalize_var(&y);
 
-    return std::hash<std::string>()(std::string(coord.begin(), coord.end()));
+    // x is uniformly distributed, its low 64 bits and the oddness of y are
+    // enough for hash tables.
+    unsigned char buffer[32];
+    secp256k1_fe_get_b32(buffer, &x);
+    uint64_t result = 0;
+    for (int i = 24; i < 32; ++i)
+        result = (result << 8) | buffer[i];
+    return static_cast<std::size_t>(result ^ secp256k1_fe_is_odd(&y));
 }
 
 const void* GroupElement::get_value() const {
@@ -12,73 +12,207 @@
 #include "scratch_impl.h"
 #include "ecmult_impl.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
-typedef struct {
-    secp256k1_scalar *sc;
-    secp256k1_gej *pt;
-} ecmult_multi_data;
+namespace secp_primitives {
+
+namespace {
+
+// Window of the precomputed tables of fixed bases.
+const int FIXED_BASE_WINDOW = 8;
+const int FIXED_BASE_TABLE_SIZE = ECMULT_TABLE_SIZE(FIXED_BASE_WINDOW);
+#ifdef USE_ENDOMORPHISM
+const int FIXED_BASE_WNAF_SIZE = 130;
+#else
+const int FIXED_BASE_WNAF_SIZE = 256;
+#endif
+
+// Memory kept by each thread between multi-exponentiations.
+class ThreadScratch {
+public:
+    ThreadScratch() : scratch(secp256k1_scratch_create(NULL, 0)) {}
+    ~ThreadScratch() { secp256k1_scratch_destroy(scratch); }
+
+    // Returns the scratch space limited to max_size bytes, which is what the
+    // choice between Strauss and Pippenger is based on.
+    secp256k1_scratch* get(size_t max_size) {
+        scratch->max_size = max_size;
+        return scratch;
+    }
+
+    std::vector<const secp256k1_gej *> points;
+    std::vector<int> wnaf_1;
+    std::vector<int> bits_1;
+#ifdef USE_ENDOMORPHISM
+    std::vector<int> wnaf_lam;
+    std::vector<int> bits_lam;
+#endif
+
+private:
+    secp256k1_scratch* scratch;
+};
+
+thread_local ThreadScratch threadScratch;
+
+struct ecmult_multi_data {
+    const std::vector<const secp256k1_gej *>* points;
+    const std::vector<Scalar>* powers;
+};
 
 int ecmult_multi_callback(secp256k1_scalar *sc, secp256k1_gej *pt, size_t idx, void *cbdata) {
-    ecmult_multi_data *data = (ecmult_multi_data*) cbdata;
-    *sc = data->sc[idx];
-    *pt = data->pt[idx];
+    const ecmult_multi_data *data = reinterpret_cast<const ecmult_multi_data *>(cbdata);
+    *sc = *reinterpret_cast<const secp256k1_scalar *>((*data->powers)[idx].get_value());
+    *pt = *(*data->points)[idx];
     return 1;
 }
 
-namespace secp_primitives {
+bool gej_identical(const secp256k1_gej &a, const secp256k1_gej &b) {
+    return a.infinity == b.infinity
+        && memcmp(&a.x, &b.x, sizeof(a.x)) == 0
+        && memcmp(&a.y, &b.y, sizeof(a.y)) == 0
+        && memcmp(&a.z, &b.z, sizeof(a.z)) == 0;
+}
 
-MultiExponent::MultiExponent(const MultiExponent& other)
-        : sc_(new secp256k1_scalar[other.n_points])
-        , pt_(new secp256k1_gej[other.n_points])
-        , n_points(other.n_points)
-{
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = (reinterpret_cast<secp256k1_scalar *>(other.sc_))[i];
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = (reinterpret_cast<secp256k1_gej *>(other.pt_))[i];
+} // namespace
+
+// Odd multiples of every base of a fixed set, in affine form.
+struct FixedBaseTables::Tables {
+    std::vector<secp256k1_gej> bases;
+    std::vector<secp256k1_ge_storage> pre;
+#ifdef USE_ENDOMORPHISM
+    // The same multiples times lambda, for the second half of the split scalars
+    std::vector<secp256k1_ge_storage> pre_lam;
+#endif
+};
+
+// Strauss' algorithm over the precomputed tables.
+static void fixed_base_multiple(const FixedBaseTables::Tables& table, const std::vector<Scalar>& powers, std::size_t n, secp256k1_gej *r) {
+    ThreadScratch& scratch = threadScratch;
+    scratch.wnaf_1.resize(n * FIXED_BASE_WNAF_SIZE);
+    scratch.bits_1.resize(n);
+#ifdef USE_ENDOMORPHISM
+    scratch.wnaf_lam.resize(n * FIXED_BASE_WNAF_SIZE);
+    scratch.bits_lam.resize(n);
+#endif
+
+    int bits = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const secp256k1_scalar *sc = reinterpret_cast<const secp256k1_scalar *>(powers[i].get_value());
+#ifdef USE_ENDOMORPHISM
+        secp256k1_scalar na_1, na_lam;
+        secp256k1_scalar_split_lambda(&na_1, &na_lam, sc);
+        scratch.bits_1[i] = secp256k1_ecmult_wnaf(&scratch.wnaf_1[i * FIXED_BASE_WNAF_SIZE], FIXED_BASE_WNAF_SIZE, &na_1, FIXED_BASE_WINDOW);
+        scratch.bits_lam[i] = secp256k1_ecmult_wnaf(&scratch.wnaf_lam[i * FIXED_BASE_WNAF_SIZE], FIXED_BASE_WNAF_SIZE, &na_lam, FIXED_BASE_WINDOW);
+        bits = std::max(bits, scratch.bits_lam[i]);
+#else
+        scratch.bits_1[i] = secp256k1_ecmult_wnaf(&scratch.wnaf_1[i * FIXED_BASE_WNAF_SIZE], FIXED_BASE_WNAF_SIZE, sc, FIXED_BASE_WINDOW);
+#endif
+        bits = std::max(bits, scratch.bits_1[i]);
+    }
+
+    secp256k1_gej_set_infinity(r);
+    secp256k1_ge tmpa;
+    for (int b = bits - 1; b >= 0; b--) {
+        int d;
+        secp256k1_gej_double_var(r, r, NULL);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (b < scratch.bits_1[i] && (d = scratch.wnaf_1[i * FIXED_BASE_WNAF_SIZE + b])) {
+                ECMULT_TABLE_GET_GE_STORAGE(&tmpa, &table.pre[i * FIXED_BASE_TABLE_SIZE], d, FIXED_BASE_WINDOW);
+                secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+            }
+#ifdef USE_ENDOMORPHISM
+            if (b < scratch.bits_lam[i] && (d = scratch.wnaf_lam[i * FIXED_BASE_WNAF_SIZE + b])) {
+                ECMULT_TABLE_GET_GE_STORAGE(&tmpa, &table.pre_lam[i * FIXED_BASE_TABLE_SIZE], d, FIXED_BASE_WINDOW);
+                secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+            }
+#endif
+        }
     }
 }
 
-MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers){
-    sc_ = new secp256k1_scalar[powers.size()];
-    pt_ = new secp256k1_gej[generators.size()];
-    n_points = generators.size();
-    for(int i = 0; i < n_points; ++i)
-    {
-        (reinterpret_cast<secp256k1_scalar *>(sc_))[i] = *reinterpret_cast<const secp256k1_scalar *>(powers[i].get_value());
-        (reinterpret_cast<secp256k1_gej *>(pt_))[i] = *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value());
+FixedBaseTables::FixedBaseTables(const std::vector<GroupElement>& bases) {
+    std::unique_ptr<Tables> tables(new Tables());
+    tables->bases.reserve(bases.size());
+    tables->pre.resize(bases.size() * FIXED_BASE_TABLE_SIZE);
+#ifdef USE_ENDOMORPHISM
+    tables->pre_lam.resize(bases.size() * FIXED_BASE_TABLE_SIZE);
+#endif
+    for (std::size_t i = 0; i < bases.size(); ++i) {
+        const secp256k1_gej *base = reinterpret_cast<const secp256k1_gej *>(bases[i].get_value());
+        // Tables can't hold the point at infinity, the bases before it are still covered
+        if (secp256k1_gej_is_infinity(base))
+            break;
+        tables->bases.push_back(*base);
+        secp256k1_ecmult_odd_multiples_table_storage_var(FIXED_BASE_TABLE_SIZE, &tables->pre[i * FIXED_BASE_TABLE_SIZE], base, NULL);
+#ifdef USE_ENDOMORPHISM
+        for (int j = 0; j < FIXED_BASE_TABLE_SIZE; ++j) {
+            secp256k1_ge ge;
+            secp256k1_ge_from_storage(&ge, &tables->pre[i * FIXED_BASE_TABLE_SIZE + j]);
+            secp256k1_ge_mul_lambda(&ge, &ge);
+            secp256k1_ge_to_storage(&tables->pre_lam[i * FIXED_BASE_TABLE_SIZE + j], &ge);
+        }
+#endif
     }
+    tables_ = std::move(tables);
+}
+
+FixedBaseTables::~FixedBaseTables() {
 }
 
-MultiExponent::~MultiExponent(){
-    delete []reinterpret_cast<secp256k1_scalar *>(sc_);
-    delete []reinterpret_cast<secp256k1_gej *>(pt_);
+// Copies of a GroupElement keep its exact representation, so the generators
+// are compared as stored instead of being normalized first.
+bool FixedBaseTables::covers(const std::vector<GroupElement>& generators) const {
+    if (generators.size() > tables_->bases.size())
+        return false;
+    for (std::size_t i = 0; i < generators.size(); ++i) {
+        if (!gej_identical(tables_->bases[i], *reinterpret_cast<const secp256k1_gej *>(generators[i].get_value())))
+            return false;
+    }
+    return true;
+}
+
+MultiExponent::MultiExponent(const std::vector<GroupElement>& generators, const std::vector<Scalar>& powers,
+                             const FixedBaseTables* fixed_bases)
+        : generators_(generators)
+        , powers_(powers)
+        , fixed_bases_(fixed_bases)
+{
 }
 
 GroupElement MultiExponent::get_multiple(){
     secp256k1_gej r;
+    size_t n_points = generators_.size();
+
+    if (fixed_bases_ && fixed_bases_->covers(generators_)) {
+        fixed_base_multiple(*fixed_bases_->tables_, powers_, n_points, &r);
+        return &r;
+    }
+
+    std::vector<const secp256k1_gej *>& points = threadScratch.points;
+    points.clear();
+    for (const GroupElement& g : generators_)
+        points.push_back(reinterpret_cast<const secp256k1_gej *>(g.get_value()));
 
     ecmult_multi_data data;
-    data.sc = reinterpret_cast<secp256k1_scalar *>(sc_);
-    data.pt = reinterpret_cast<secp256k1_gej *>(pt_);
+    data.points = &points;
+    data.powers = &powers_;
 
-    secp256k1_scratch *scratch;
+    size_t scratch_size;
     if (n_points > ECMULT_PIPPENGER_THRESHOLD) {
         int bucket_window = secp256k1_pippenger_bucket_window(n_points);
-        size_t scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+        scratch_size = secp256k1_pippenger_scratch_size(n_points, bucket_window) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
     } else {
-        size_t scratch_size = secp256k1_strauss_scratch_size(n_points);
-        scratch = secp256k1_scratch_create(NULL, scratch_size + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+        scratch_size = secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
     }
 
+    // Neither algorithm touches the context when there is no G scalar
     secp256k1_ecmult_context ctx;
 
-    secp256k1_ecmult_multi_var(&ctx, scratch, &r, NULL, ecmult_multi_callback, &data, n_points);
-
-    secp256k1_scratch_destroy(scratch);
+    secp256k1_ecmult_multi_var(&ctx, threadScratch.get(scratch_size), &r, NULL, ecmult_multi_callback, &data, n_points);
 
-    return  reinterpret_cast<secp256k1_scalar *>(&r);
+    return &r;
 }
 
 }// namespace secp_primitives
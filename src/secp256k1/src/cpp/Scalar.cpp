@@ -15,36 +15,21 @@
 
 namespace secp_primitives {
 
-Scalar::Scalar()
-   : value_(new secp256k1_scalar()) {
-}
+static_assert(sizeof(secp256k1_scalar) == sizeof(Scalar), "Scalar storage does not match secp256k1_scalar");
+static_assert(alignof(secp256k1_scalar) <= alignof(Scalar), "Scalar storage is not aligned for secp256k1_scalar");
 
 Scalar::Scalar(uint64_t value)
-   : value_(new secp256k1_scalar()) {
+   : value_() {
     secp256k1_scalar_set_int(reinterpret_cast<secp256k1_scalar *>(value_), value);
 }
 
 Scalar::Scalar(const unsigned char* str)
-     : value_(new secp256k1_scalar()) {
+     : value_() {
     secp256k1_scalar_set_b32(reinterpret_cast<secp256k1_scalar *>(value_), str, 0);
 }
 
-Scalar::Scalar(const void *value)
-   : value_(new secp256k1_scalar(*reinterpret_cast<const secp256k1_scalar *>(value))) {
-
-}
-
-Scalar::Scalar(const Scalar& other)
-   : value_(new secp256k1_scalar(*reinterpret_cast<const secp256k1_scalar *>(other.value_))) {
-
-}
-
-Scalar::~Scalar() {
-    delete reinterpret_cast<secp256k1_scalar *>(value_);
-}
-
-Scalar& Scalar::operator=(const Scalar& other) {
-    return set(other);
+Scalar::Scalar(const void *value) {
+    *reinterpret_cast<secp256k1_scalar *>(value_) = *reinterpret_cast<const secp256k1_scalar *>(value);
 }
 
 Scalar& Scalar::operator=(unsigned int i) {
@@ -111,14 +96,6 @@ Scalar& Scalar::operator-=(const Scalar& other) {
     return *this;
 }
 
-bool Scalar::operator==(const Scalar& other) const {
-    return secp256k1_scalar_eq(reinterpret_cast<const secp256k1_scalar *>(value_), reinterpret_cast<const secp256k1_scalar *>(other.value_));
-}
-
-bool Scalar::operator!=(const Scalar& other) const {
-    return !(secp256k1_scalar_eq(reinterpret_cast<const secp256k1_scalar *>(value_), reinterpret_cast<const secp256k1_scalar *>(other.value_)));
-}
-
 const void * Scalar::get_value() const {
     return value_;
 }
@@ -302,7 +279,7 @@ std::string Scalar::GetHex() const {
     return ss.str();
 }
 
-void Scalar::SetHex(const std::string& str) const {
+void Scalar::SetHex(const std::string& str) {
     unsigned char buffer[32];
 
     for (int i = 0; i < 32; i+=2)
@@ -807,11 +807,14 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
     secp256k1_scalar *scalars;
     secp256k1_gej *buckets;
     struct secp256k1_pippenger_state *state_space;
+    secp256k1_fe fe_one;
     size_t idx = 0;
     size_t point_idx = 0;
     int i, j;
     int bucket_window;
 
+    secp256k1_fe_set_int(&fe_one, 1);
+
     (void)ctx;
     secp256k1_gej_set_infinity(r);
     if (inp_g_sc == NULL && n_points == 0) {
@@ -845,7 +848,14 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_ecmult_context *ctx,
             secp256k1_scratch_deallocate_frame(scratch);
             return 0;
         }
-        secp256k1_ge_set_gej(&points[idx], &point);
+        if (!point.infinity && secp256k1_fe_equal_var(&fe_one, &point.z)) {
+            /* Points that are already affine do not need a field inversion. */
+            secp256k1_ge_set_xy(&points[idx], &point.x, &point.y);
+            secp256k1_fe_normalize_weak(&points[idx].x);
+            secp256k1_fe_normalize_weak(&points[idx].y);
+        } else {
+            secp256k1_ge_set_gej(&points[idx], &point);
+        }
         idx++;
 #ifdef USE_ENDOMORPHISM
         secp256k1_ecmult_endo_split(&scalars[idx - 1], &scalars[idx], &points[idx - 1], &points[idx]);
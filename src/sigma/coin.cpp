@@ -162,6 +162,9 @@ PublicCoin::PublicCoin(const GroupElement& coin, const CoinDenomination d)
     : value(coin)
     , denomination(d)
 {
+    // Kept affine, like coins read from disk, so hashing and comparing the
+    // coin does not invert its coordinates.
+    value.normalize();
 }
 
 const GroupElement& PublicCoin::getValue() const{
@@ -312,16 +315,7 @@ std::size_t CScalarHash::operator ()(const Scalar& bn) const noexcept {
 }
 
 std::size_t CPublicCoinHash::operator ()(const PublicCoin& coin) const noexcept {
-    vector<unsigned char> bnData(coin.getValue().memoryRequired());
-    coin.getValue().serialize(&bnData[0]);
-
-    unsigned char hash[CSHA256::OUTPUT_SIZE];
-    CSHA256().Write(&bnData[0], bnData.size()).Finalize(hash);
-
-    // take the first bytes of "hash".
-    std::size_t result;
-    std::memcpy(&result, hash, sizeof(std::size_t));
-    return result;
+    return coin.getValue().hash();
 }
 
 } // namespace sigma
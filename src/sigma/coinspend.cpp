@@ -25,7 +25,8 @@ CoinSpend::CoinSpend(
         params->get_g(),
         params->get_h(),
         params->get_n(),
-        params->get_m());
+        params->get_m(),
+        params->get_h_tables());
     //compute inverse of g^s
     GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
     std::vector<GroupElement> C_;
@@ -39,12 +40,15 @@ CoinSpend::CoinSpend(
             indexFound = true;
         }
 
-        C_.emplace_back(anonymity_set[j].getValue() + gs);
+        C_.emplace_back(anonymity_set[j].getValue());
     }
 
     if(!indexFound)
         throw ZerocoinException("No such coin in this anonymity set");
 
+    // Shift the whole set by g^-s at once, leaving the points in affine form
+    GroupElement::add_to_all(C_, gs);
+
     sigmaProver.proof(C_, coinIndex, coin.getRandomness(), fPadding, sigmaProof);
 
     updateMetaData(coin, m);
@@ -100,14 +104,21 @@ bool CoinSpend::Verify(
         const std::vector<PublicCoin>& anonymity_set,
         const SpendMetaData& m,
         bool fPadding) const {
-    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m());
-    //compute inverse of g^s
-    GroupElement gs = (params->get_g() * coinSerialNumber).inverse();
-    std::vector<GroupElement> C_;
-    C_.reserve(anonymity_set.size());
+    if (!VerifySignature(m))
+        return false;
+
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(params->get_g(), params->get_h(), params->get_n(), params->get_m(), params->get_h_tables());
+    std::vector<GroupElement> commits;
+    commits.reserve(anonymity_set.size());
     for(std::size_t j = 0; j < anonymity_set.size(); ++j)
-        C_.emplace_back(anonymity_set[j].getValue() + gs);
+        commits.emplace_back(anonymity_set[j].getValue());
+
+    // Now verify the sigma proof itself. The g^-s shift of the coins is
+    // folded into the exponents rather than applied to every coin.
+    return sigmaVerifier.batch_verify(commits, {coinSerialNumber}, {fPadding}, {&sigmaProof});
+}
 
+bool CoinSpend::VerifySignature(const SpendMetaData& m) const {
     uint256 metahash = signatureHash(m);
 
     // Verify ecdsa_signature, to make sure someone did not change the output of transaction.
@@ -138,8 +149,36 @@ bool CoinSpend::Verify(
         return false;
     }
 
-    // Now verify the sigma proof itself.
-    return sigmaVerifier.verify(C_, sigmaProof, fPadding);
+    return true;
+}
+
+bool CoinSpend::BatchVerify(
+        const Params* p,
+        const std::vector<PublicCoin>& anonymity_set,
+        const std::vector<const CoinSpend*>& spends,
+        const std::vector<SpendMetaData>& metadata,
+        const std::vector<bool>& fPadding) {
+    if (spends.size() != metadata.size() || spends.size() != fPadding.size())
+        return false;
+
+    std::vector<Scalar> serials;
+    std::vector<const SigmaPlusProof<Scalar, GroupElement>*> proofs;
+    serials.reserve(spends.size());
+    proofs.reserve(spends.size());
+    for (std::size_t i = 0; i < spends.size(); ++i) {
+        if (!spends[i]->VerifySignature(metadata[i]))
+            return false;
+        serials.push_back(spends[i]->coinSerialNumber);
+        proofs.push_back(&spends[i]->sigmaProof);
+    }
+
+    std::vector<GroupElement> commits;
+    commits.reserve(anonymity_set.size());
+    for (const PublicCoin& coin : anonymity_set)
+        commits.emplace_back(coin.getValue());
+
+    SigmaPlusVerifier<Scalar, GroupElement> sigmaVerifier(p->get_g(), p->get_h(), p->get_n(), p->get_m(), p->get_h_tables());
+    return sigmaVerifier.batch_verify(commits, serials, fPadding, proofs);
 }
 
 const Scalar& CoinSpend::getCoinSerialNumber() {
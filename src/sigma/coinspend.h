@@ -52,6 +52,18 @@ public:
 
     bool Verify(const std::vector<PublicCoin>& anonymity_set, const SpendMetaData &m, bool fPadding) const;
 
+    // Checks the ecdsa signature over the metadata and that it matches the coin serial.
+    bool VerifySignature(const SpendMetaData &m) const;
+
+    // Verifies spends that share one anonymity set with a single multi-exponentiation.
+    // Returns false if any of them is invalid, without telling which one.
+    static bool BatchVerify(
+        const Params* p,
+        const std::vector<PublicCoin>& anonymity_set,
+        const std::vector<const CoinSpend*>& spends,
+        const std::vector<SpendMetaData>& metadata,
+        const std::vector<bool>& fPadding);
+
     ADD_SERIALIZE_METHODS;
     template <typename Stream, typename Operation>
     void SerializationOp(Stream& s, Operation ser_action) {
@@ -35,6 +35,7 @@ Params::Params(const GroupElement& g, int n, int m) :
         h_[i - 1].sha256(buff);
         h_[i].generate(buff);
     }
+    h_tables_.reset(new FixedBaseTables(h_));
 }
 
 Params::~Params(){
@@ -52,6 +53,10 @@ const std::vector<GroupElement>& Params::get_h() const{
     return h_;
 }
 
+const FixedBaseTables* Params::get_h_tables() const{
+    return h_tables_.get();
+}
+
 uint64_t Params::get_n() const{
     return n_;
 }
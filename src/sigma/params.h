@@ -15,6 +15,8 @@ public:
     const GroupElement& get_g() const;
     const GroupElement& get_h0() const;
     const std::vector<GroupElement>& get_h() const;
+    // Window tables of the h generators for the commitments over them
+    const FixedBaseTables* get_h_tables() const;
     uint64_t get_n() const;
     uint64_t get_m() const;
 
@@ -26,6 +28,7 @@ private:
     static Params* instance;
     GroupElement g_;
     std::vector<GroupElement> h_;
+    std::unique_ptr<FixedBaseTables> h_tables_;
     int m_;
     int n_;
 };
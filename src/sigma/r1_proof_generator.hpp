@@ -9,14 +9,16 @@ R1ProofGenerator<Exponent,GroupElement>::R1ProofGenerator(
         const std::vector<Exponent>& b,
         const Exponent& r,
         int n ,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseTables* h_tables)
     : g_(g)
     , h_(h_gens)
+    , h_tables_(h_tables)
     , b_(b)
     , r(r)
     , n_(n)
     , m_(m){
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_,b_,r,B_Commit);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, b_, r, B_Commit, h_tables_);
 }
 
 template<class Exponent, class GroupElement>
@@ -45,7 +47,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement A;
     while(!A.isMember() || A.isInfinity()) {
         rA.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a, rA, A);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, a, rA, A, h_tables_);
     }
     proof_out.A_ = A;
     //compute C
@@ -57,7 +59,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement C;
     while(!C.isMember() || C.isInfinity()) {
         rC.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC, C);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, c, rC, C, h_tables_);
     }
     proof_out.C_ = C;
     //compute D
@@ -69,7 +71,7 @@ void R1ProofGenerator<Exponent,GroupElement>::proof(
     GroupElement D;
     while(!D.isMember() || D.isInfinity()) {
         rD.randomize();
-        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, d, rD, D);
+        SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, d, rD, D, h_tables_);
     }
     Exponent x;
     proof_out.D_ = D;
@@ -9,9 +9,11 @@ R1ProofVerifier<Exponent,GroupElement>::R1ProofVerifier(
         const std::vector<GroupElement>& h_gens,
         const GroupElement& B,
         int n ,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseTables* h_tables)
     : g_(g)
     , h_(h_gens)
+    , h_tables_(h_tables)
     , B_Commit(B)
     , n_(n)
     , m_(m){
@@ -66,7 +68,7 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify(
     }
 
     GroupElement one;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_, proof_.ZA_, one);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_, proof_.ZA_, one, h_tables_);
     if((B_Commit * x + proof_.A_) != one)
         return false;
 
@@ -75,7 +77,7 @@ bool R1ProofVerifier<Exponent,GroupElement>::verify(
     for (std::size_t i = 0; i < f_.size(); i++)
         f_prime.emplace_back(f_[i] * (x - f_[i]));
     GroupElement two;
-    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_prime, proof_.ZC_, two);
+    SigmaPrimitives<Exponent, GroupElement>::commit(g_, h_, f_prime, proof_.ZC_, two, h_tables_);
     if((proof_.C_ * x + proof_.D_) != two)
         return false;
 
@@ -18,7 +18,8 @@ public:
             const std::vector<GroupElement>& h,
             const std::vector<Exponent>& exp,
             const Exponent& r,
-            GroupElement& result_out);
+            GroupElement& result_out,
+            const secp_primitives::FixedBaseTables* h_tables = nullptr);
 
     static GroupElement commit(const GroupElement& g, const Exponent m, const GroupElement h, const Exponent r);
 
@@ -7,8 +7,9 @@ void SigmaPrimitives<Exponent, GroupElement>::commit(const GroupElement& g,
         const std::vector<GroupElement>& h,
         const std::vector<Exponent>& exp,
         const Exponent& r,
-        GroupElement& result_out)  {
-    secp_primitives::MultiExponent mult(h, exp);
+        GroupElement& result_out,
+        const secp_primitives::FixedBaseTables* h_tables)  {
+    secp_primitives::MultiExponent mult(h, exp, h_tables);
     result_out += g * r + mult.get_multiple();
 }
 
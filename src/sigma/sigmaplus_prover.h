@@ -14,7 +14,8 @@ class SigmaPlusProver{
 
 public:
     SigmaPlusProver(const GroupElement& g,
-                    const std::vector<GroupElement>& h_gens, int n, int m);
+                    const std::vector<GroupElement>& h_gens, int n, int m,
+                    const secp_primitives::FixedBaseTables* h_tables = nullptr);
     void proof(const std::vector<GroupElement>& commits,
                std::size_t l,
                const Exponent& r,
@@ -24,6 +25,7 @@ public:
 private:
     GroupElement g_;
     std::vector<GroupElement> h_;
+    const secp_primitives::FixedBaseTables* h_tables_;
     int n_;
     int m_;
 };
@@ -7,9 +7,11 @@ SigmaPlusProver<Exponent, GroupElement>::SigmaPlusProver(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseTables* h_tables)
     : g_(g)
     , h_(h_gens)
+    , h_tables_(h_tables)
     , n_(n)
     , m_(m) {
 }
@@ -38,7 +40,7 @@ void SigmaPlusProver<Exponent, GroupElement>::proof(
         Pk[k].randomize();
     }
 
-    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_);
+    R1ProofGenerator<secp_primitives::Scalar, secp_primitives::GroupElement> r1prover(g_, h_, sigma, rB, n_, m_, h_tables_);
     proof_out.B_ = r1prover.get_B();
     std::vector<Exponent> a;
     r1prover.proof(a, proof_out.r1Proof_);
@@ -14,15 +14,35 @@ class SigmaPlusVerifier{
 public:
     SigmaPlusVerifier(const GroupElement& g,
                       const std::vector<GroupElement>& h_gens,
-                      int n, int m_);
+                      int n, int m_,
+                      const secp_primitives::FixedBaseTables* h_tables = nullptr);
 
     bool verify(const std::vector<GroupElement>& commits,
                 const SigmaPlusProof<Exponent, GroupElement>& proof,
                 bool fPadding) const;
 
+    // Verifies several proofs against the same set of commitments at once.
+    // Commitments are taken without the serial offset, i.e. C_j = commits[j] - g^serials[t].
+    // The final checks of all proofs are merged into one multi-exponentiation using
+    // random weights, so a false result does not tell which proof is invalid.
+    bool batch_verify(const std::vector<GroupElement>& commits,
+                      const std::vector<Exponent>& serials,
+                      const std::vector<bool>& fPadding,
+                      const std::vector<const SigmaPlusProof<Exponent, GroupElement>*>& proofs) const;
+
+private:
+    // Checks everything except the final equation and computes the exponents
+    // for each of the N commitments.
+    bool compute_fis(const SigmaPlusProof<Exponent, GroupElement>& proof,
+                     std::size_t N,
+                     bool fPadding,
+                     std::vector<Exponent>& f_i_,
+                     Exponent& x) const;
+
 private:
     GroupElement g_;
     std::vector<GroupElement> h_;
+    const secp_primitives::FixedBaseTables* h_tables_;
     int n;
     int m;
 };
@@ -6,9 +6,11 @@ SigmaPlusVerifier<Exponent, GroupElement>::SigmaPlusVerifier(
         const GroupElement& g,
         const std::vector<GroupElement>& h_gens,
         int n,
-        int m)
+        int m,
+        const secp_primitives::FixedBaseTables* h_tables)
     : g_(g)
     , h_(h_gens)
+    , h_tables_(h_tables)
     , n(n)
     , m(m){
 }
@@ -19,7 +21,114 @@ bool  SigmaPlusVerifier<Exponent, GroupElement>::verify(
         const SigmaPlusProof<Exponent, GroupElement>& proof,
         bool fPadding) const {
 
-    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m);
+    std::vector<Exponent> f_i_;
+    Exponent x;
+    if (!compute_fis(proof, commits.size(), fPadding, f_i_, x))
+        return false;
+
+    const std::vector <GroupElement>& Gk = proof.Gk_;
+    secp_primitives::MultiExponent mult(commits, f_i_);
+    GroupElement t1 = mult.get_multiple();
+    GroupElement t2;
+    Exponent x_k(uint64_t(1));
+    for(int k = 0; k < m; ++k){
+        t2 += (Gk[k] * (x_k.negate()));
+        x_k *= x;
+    }
+
+    GroupElement left(t1 + t2);
+    if(left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_))
+        return false;
+
+    return true;
+}
+
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::batch_verify(
+        const std::vector<GroupElement>& commits,
+        const std::vector<Exponent>& serials,
+        const std::vector<bool>& fPadding,
+        const std::vector<const SigmaPlusProof<Exponent, GroupElement>*>& proofs) const {
+
+    std::size_t N = commits.size();
+    std::size_t T = proofs.size();
+    if (T == 0)
+        return true;
+    if (serials.size() != T || fPadding.size() != T)
+        return false;
+
+    /*
+     * Every proof t checks (in TeX notation)
+     *
+     *   \prod_{i} (c_i g^{-s_t})^{f^t_i} \prod_{k} G^t_k^{-x_t^k} = h_0^{z_t}
+     *
+     * Raising each equation to a random y_t and multiplying them together gives
+     *
+     *   \prod_{i} c_i^{\sum_t y_t f^t_i} g^{-\sum_t y_t s_t \sum_i f^t_i}
+     *     h_0^{-\sum_t y_t z_t} \prod_{t,k} G^t_k^{-y_t x_t^k} = 1
+     *
+     * so the anonymity set goes through the multi-exponentiation only once,
+     * and g^{-s_t} is folded into the exponents instead of being added to
+     * every coin.
+     */
+    std::vector<Exponent> coin_exps(N, Exponent(uint64_t(0)));
+    Exponent g_exp(uint64_t(0));
+    Exponent h0_exp(uint64_t(0));
+
+    std::vector<GroupElement> points;
+    std::vector<Exponent> exps;
+    points.reserve(N + 2 + T * m);
+    exps.reserve(N + 2 + T * m);
+    points.insert(points.end(), commits.begin(), commits.end());
+
+    std::vector<Exponent> f_i_;
+    for (std::size_t t = 0; t < T; ++t) {
+        Exponent x;
+        f_i_.clear();
+        if (!compute_fis(*proofs[t], N, fPadding[t], f_i_, x))
+            return false;
+
+        // A single proof is checked as is, there is nothing to combine it with
+        Exponent y(uint64_t(1));
+        if (T > 1)
+            y.randomize();
+
+        Exponent f_sum(uint64_t(0));
+        for (std::size_t i = 0; i < N; ++i) {
+            Exponent yf = y * f_i_[i];
+            coin_exps[i] += yf;
+            f_sum += yf;
+        }
+        g_exp -= serials[t] * f_sum;
+        h0_exp -= y * proofs[t]->z_;
+
+        Exponent x_k(y);
+        for (int k = 0; k < m; ++k) {
+            points.emplace_back(proofs[t]->Gk_[k]);
+            exps.emplace_back(x_k.negate());
+            x_k *= x;
+        }
+    }
+
+    exps.insert(exps.begin(), coin_exps.begin(), coin_exps.end());
+    points.emplace_back(g_);
+    exps.emplace_back(g_exp);
+    points.emplace_back(h_[0]);
+    exps.emplace_back(h0_exp);
+
+    secp_primitives::MultiExponent mult(points, exps);
+    return mult.get_multiple().isInfinity();
+}
+
+template<class Exponent, class GroupElement>
+bool SigmaPlusVerifier<Exponent, GroupElement>::compute_fis(
+        const SigmaPlusProof<Exponent, GroupElement>& proof,
+        std::size_t N,
+        bool fPadding,
+        std::vector<Exponent>& f_i_,
+        Exponent& x) const {
+
+    R1ProofVerifier<Exponent, GroupElement> r1ProofVerifier(g_, h_, proof.B_, n, m, h_tables_);
     std::vector<Exponent> f;
     const R1Proof<Exponent, GroupElement>& r1Proof = proof.r1Proof_;
 
@@ -44,14 +153,11 @@ bool  SigmaPlusVerifier<Exponent, GroupElement>::verify(
         return false;
     }
 
-    if (commits.empty()) {
+    if (N == 0) {
         LogPrintf("No mints in the anonymity set");
         return false;
     }
 
-    std::size_t N = commits.size();
-
-    std::vector<Exponent> f_i_;
     f_i_.reserve(N);
     for (std::size_t i = 0; i < (fPadding ? N-1 : N); ++i) {
         std::vector<uint64_t> I = SigmaPrimitives<Exponent, GroupElement>::convert_to_nal(i, n, m);
@@ -62,7 +168,7 @@ bool  SigmaPlusVerifier<Exponent, GroupElement>::verify(
         f_i_.emplace_back(f_i);
     }
 
-    Exponent x = r1ProofVerifier.x_;
+    x = r1ProofVerifier.x_;
 
     if (fPadding) {
         /*
@@ -99,19 +205,6 @@ bool  SigmaPlusVerifier<Exponent, GroupElement>::verify(
         f_i_.emplace_back(pow);
     }
 
-    secp_primitives::MultiExponent mult(commits, f_i_);
-    GroupElement t1 = mult.get_multiple();
-    GroupElement t2;
-    Exponent x_k(uint64_t(1));
-    for(int k = 0; k < m; ++k){
-        t2 += (Gk[k] * (x_k.negate()));
-        x_k *= x;
-    }
-
-    GroupElement left(t1 + t2);
-    if(left != SigmaPrimitives<Exponent, GroupElement>::commit(g_, Exponent(uint64_t(0)), h_[0], proof.z_))
-        return false;
-
     return true;
 }
 
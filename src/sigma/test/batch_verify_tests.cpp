@@ -0,0 +1,229 @@
+#include "../coinspend.h"
+#include "../params.h"
+#include "../sigmaplus_prover.h"
+#include "../sigmaplus_verifier.h"
+#include "../../zerocoin/sigma.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace secp_primitives;
+using namespace sigma;
+
+namespace {
+
+typedef SigmaPlusProof<Scalar, GroupElement> Proof;
+
+// Proofs over at most 4^3 commitments, so that they are quick to generate
+const int n = 4;
+const int m = 3;
+
+struct batch_verify_fixture {
+    const sigma::Params* params;
+    std::vector<GroupElement> h_gens;
+    std::vector<GroupElement> commits;
+    std::vector<Scalar> serials;
+    std::vector<Proof> proofs;
+
+    batch_verify_fixture() : params(sigma::Params::get_default()) {
+        h_gens.assign(params->get_h().begin(), params->get_h().begin() + n * m);
+    }
+
+    // Fills a set of N random commitments of which T are coins with known
+    // openings, and proves the ownership of each of those.
+    void create_proofs(std::size_t N, std::size_t T, bool fPadding) {
+        const GroupElement& g = params->get_g();
+        commits.resize(N);
+        for (GroupElement& c : commits)
+            c.randomize();
+
+        std::vector<std::size_t> indexes;
+        std::vector<Scalar> randomness(T);
+        serials.resize(T);
+        for (std::size_t t = 0; t < T; ++t) {
+            indexes.push_back(t * (N / T));
+            serials[t].randomize();
+            randomness[t].randomize();
+            commits[indexes[t]] = SigmaPrimitives<Scalar, GroupElement>::commit(g, serials[t], h_gens[0], randomness[t]);
+        }
+
+        SigmaPlusProver<Scalar, GroupElement> prover(g, h_gens, n, m, params->get_h_tables());
+        proofs.assign(T, Proof(params));
+        for (std::size_t t = 0; t < T; ++t) {
+            std::vector<GroupElement> C_(commits);
+            GroupElement::add_to_all(C_, (g * serials[t]).inverse());
+            prover.proof(C_, indexes[t], randomness[t], fPadding, proofs[t]);
+        }
+    }
+
+    // The single proof check, over the commitments shifted by g^-s
+    bool verify_one(std::size_t t, bool fPadding) const {
+        SigmaPlusVerifier<Scalar, GroupElement> verifier(params->get_g(), h_gens, n, m, params->get_h_tables());
+        std::vector<GroupElement> C_(commits);
+        GroupElement gs = (params->get_g() * serials[t]).inverse();
+        for (GroupElement& c : C_)
+            c += gs;
+        return verifier.verify(C_, proofs[t], fPadding);
+    }
+
+    bool verify_batch(const std::vector<Scalar>& batch_serials, const std::vector<const Proof*>& batch_proofs, bool fPadding) const {
+        SigmaPlusVerifier<Scalar, GroupElement> verifier(params->get_g(), h_gens, n, m, params->get_h_tables());
+        return verifier.batch_verify(commits, batch_serials, std::vector<bool>(batch_proofs.size(), fPadding), batch_proofs);
+    }
+
+    std::vector<const Proof*> all_proofs() const {
+        std::vector<const Proof*> result;
+        for (const Proof& proof : proofs)
+            result.push_back(&proof);
+        return result;
+    }
+};
+
+// Builds spends of the first coins of an anonymity set, as carried by sigma spend transactions
+struct CoinSpends {
+    std::vector<PublicCoin> anonymity_set;
+    std::vector<std::unique_ptr<CoinSpend>> spends;
+    std::vector<SpendMetaData> metadata;
+
+    CoinSpends(const sigma::Params* params, std::size_t nCoins, std::size_t nSpends) {
+        std::vector<PrivateCoin> coins;
+        for (std::size_t i = 0; i < nCoins; ++i) {
+            coins.emplace_back(params, CoinDenomination::SIGMA_1, SIGMA_VERSION_2);
+            anonymity_set.push_back(coins.back().getPublicCoin());
+        }
+
+        uint256 blockHash;
+        blockHash.SetHex("1");
+        for (std::size_t i = 0; i < nSpends; ++i) {
+            SpendMetaData m(1, blockHash, GetRandHash());
+            spends.emplace_back(new CoinSpend(params, coins[i], anonymity_set, m, true));
+            spends.back()->setVersion(SIGMA_VERSION_2);
+            metadata.push_back(m);
+        }
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(sigma_batch_verify_tests, batch_verify_fixture)
+
+BOOST_AUTO_TEST_CASE(batch_matches_single_proofs)
+{
+    for (bool fPadding : {false, true}) {
+        // Padding lets the set be smaller than n^m
+        create_proofs(fPadding ? 50 : 64, 4, fPadding);
+
+        for (std::size_t t = 0; t < proofs.size(); ++t) {
+            BOOST_CHECK(verify_one(t, fPadding));
+            BOOST_CHECK(verify_batch({serials[t]}, {&proofs[t]}, fPadding));
+        }
+        BOOST_CHECK(verify_batch(serials, all_proofs(), fPadding));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_rejects_one_invalid_proof)
+{
+    create_proofs(64, 4, false);
+    BOOST_CHECK(verify_batch(serials, all_proofs(), false));
+
+    // A proof with a wrong response fails on its own and takes the batch with it
+    proofs[2].z_ += Scalar(uint64_t(1));
+    BOOST_CHECK(!verify_one(2, false));
+    BOOST_CHECK(!verify_batch(serials, all_proofs(), false));
+
+    std::vector<Scalar> valid_serials(serials);
+    std::vector<const Proof*> valid_proofs = all_proofs();
+    valid_serials.erase(valid_serials.begin() + 2);
+    valid_proofs.erase(valid_proofs.begin() + 2);
+    BOOST_CHECK(verify_batch(valid_serials, valid_proofs, false));
+
+    // So does a valid proof claimed for another serial
+    valid_serials[1].randomize();
+    BOOST_CHECK(!verify_batch(valid_serials, valid_proofs, false));
+}
+
+BOOST_AUTO_TEST_CASE(batch_edge_cases)
+{
+    create_proofs(64, 2, false);
+
+    // Nothing to check
+    BOOST_CHECK(verify_batch({}, {}, false));
+
+    // Serials and proofs have to match up
+    SigmaPlusVerifier<Scalar, GroupElement> verifier(params->get_g(), h_gens, n, m, params->get_h_tables());
+    BOOST_CHECK(!verifier.batch_verify(commits, {serials[0]}, {false, false}, all_proofs()));
+    BOOST_CHECK(!verifier.batch_verify(commits, serials, {false}, all_proofs()));
+
+    // The same proof twice is as valid as once
+    BOOST_CHECK(verify_batch({serials[0], serials[0]}, {&proofs[0], &proofs[0]}, false));
+
+    // A zero serial is not special cased, the proof just doesn't match it
+    Scalar zero(uint64_t(0));
+    BOOST_CHECK(!verify_batch({zero}, {&proofs[0]}, false));
+}
+
+BOOST_AUTO_TEST_CASE(coinspend_batch_verify)
+{
+    CoinSpends coinSpends(params, 16, 3);
+
+    std::vector<const CoinSpend*> batch;
+    for (const auto& spend : coinSpends.spends) {
+        BOOST_CHECK(spend->Verify(coinSpends.anonymity_set, coinSpends.metadata[batch.size()], true));
+        batch.push_back(spend.get());
+    }
+    std::vector<bool> fPadding(batch.size(), true);
+    BOOST_CHECK(CoinSpend::BatchVerify(params, coinSpends.anonymity_set, batch, coinSpends.metadata, fPadding));
+
+    // Metadata of another transaction breaks the signature of that spend only
+    std::vector<SpendMetaData> metadata(coinSpends.metadata);
+    metadata[1].txHash = GetRandHash();
+    BOOST_CHECK(!CoinSpend::BatchVerify(params, coinSpends.anonymity_set, batch, metadata, fPadding));
+
+    // Against a different set every proof fails
+    std::vector<PublicCoin> other_set(coinSpends.anonymity_set);
+    other_set.back() = PrivateCoin(params, CoinDenomination::SIGMA_1, SIGMA_VERSION_2).getPublicCoin();
+    BOOST_CHECK(!CoinSpend::BatchVerify(params, other_set, batch, coinSpends.metadata, fPadding));
+}
+
+BOOST_AUTO_TEST_CASE(spend_batch_verify)
+{
+    InitSigmaVerificationCache();
+
+    const CSigmaSpendBatch::GroupKey key = std::make_tuple(CoinDenomination::SIGMA_1, 1, (std::size_t)16);
+
+    // A batch of valid spends passes and is emptied
+    {
+        CoinSpends coinSpends(params, 16, 3);
+        CSigmaSpendBatch spendBatch;
+        std::vector<PublicCoin> anonymity_set(coinSpends.anonymity_set);
+        for (std::size_t i = 0; i < coinSpends.spends.size(); ++i) {
+            if (spendBatch.HasAnonymitySet(key))
+                spendBatch.Add(key, std::move(coinSpends.spends[i]), coinSpends.metadata[i], true, GetRandHash());
+            else
+                spendBatch.Add(key, std::move(anonymity_set), std::move(coinSpends.spends[i]), coinSpends.metadata[i], true, GetRandHash());
+        }
+        BOOST_CHECK(!spendBatch.IsEmpty());
+        BOOST_CHECK(spendBatch.Verify(1));
+        BOOST_CHECK(spendBatch.IsEmpty());
+    }
+
+    // One spend proven against another set is caught, wherever it is in the batch
+    for (std::size_t nInvalid = 0; nInvalid < 3; ++nInvalid) {
+        CoinSpends coinSpends(params, 16, 3);
+
+        std::vector<PublicCoin> other_set(coinSpends.anonymity_set);
+        PrivateCoin other(params, CoinDenomination::SIGMA_1, SIGMA_VERSION_2);
+        other_set.back() = other.getPublicCoin();
+        coinSpends.spends[nInvalid].reset(new CoinSpend(params, other, other_set, coinSpends.metadata[nInvalid], true));
+        coinSpends.spends[nInvalid]->setVersion(SIGMA_VERSION_2);
+
+        CSigmaSpendBatch spendBatch;
+        std::vector<PublicCoin> anonymity_set(coinSpends.anonymity_set);
+        spendBatch.Add(key, std::move(anonymity_set), std::move(coinSpends.spends[0]), coinSpends.metadata[0], true, GetRandHash());
+        for (std::size_t i = 1; i < coinSpends.spends.size(); ++i)
+            spendBatch.Add(key, std::move(coinSpends.spends[i]), coinSpends.metadata[i], true, GetRandHash());
+        BOOST_CHECK(!spendBatch.Verify(1));
+        BOOST_CHECK(spendBatch.IsEmpty());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+#include "../coin.h"
+
+#include "../../streams.h"
+#include "../../version.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <unordered_set>
+
+BOOST_AUTO_TEST_SUITE(sigma_coin_hash_tests)
+
+BOOST_AUTO_TEST_CASE(pubcoin_equality)
+{
+    secp_primitives::GroupElement value;
+    value.randomize();
+    value.square();
+    secp_primitives::GroupElement normalized(value);
+    normalized.normalize();
+
+    sigma::PublicCoin coin(value, sigma::CoinDenomination::SIGMA_1);
+    sigma::PublicCoin other(normalized, sigma::CoinDenomination::SIGMA_1);
+    BOOST_CHECK(coin == other);
+    BOOST_CHECK(sigma::CPublicCoinHash()(coin) == sigma::CPublicCoinHash()(other));
+
+    CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+    serialized << coin;
+    sigma::PublicCoin deserialized;
+    serialized >> deserialized;
+    BOOST_CHECK(deserialized == coin);
+    BOOST_CHECK(sigma::CPublicCoinHash()(deserialized) == sigma::CPublicCoinHash()(coin));
+
+    sigma::PublicCoin negated(value.inverse(), sigma::CoinDenomination::SIGMA_1);
+    BOOST_CHECK(negated != coin);
+}
+
+BOOST_AUTO_TEST_CASE(pubcoin_hash_set)
+{
+    // Minted coins are looked up by coins read from transactions and from disk
+    std::vector<secp_primitives::GroupElement> values(500);
+    std::unordered_set<sigma::PublicCoin, sigma::CPublicCoinHash> coins;
+    for (secp_primitives::GroupElement& value : values) {
+        value.randomize();
+        value.square();
+        coins.insert(sigma::PublicCoin(value, sigma::CoinDenomination::SIGMA_10));
+    }
+    BOOST_CHECK(coins.size() == values.size());
+
+    for (const secp_primitives::GroupElement& value : values) {
+        sigma::PublicCoin coin(value, sigma::CoinDenomination::SIGMA_10);
+        BOOST_CHECK(coins.count(coin) == 1);
+
+        CDataStream serialized(SER_NETWORK, PROTOCOL_VERSION);
+        serialized << coin;
+        sigma::PublicCoin deserialized;
+        serialized >> deserialized;
+        BOOST_CHECK(coins.count(deserialized) == 1);
+    }
+
+    secp_primitives::GroupElement missing;
+    missing.randomize();
+    BOOST_CHECK(coins.count(sigma::PublicCoin(missing, sigma::CoinDenomination::SIGMA_10)) == 0);
+    BOOST_CHECK(coins.count(sigma::PublicCoin(values[0].inverse(), sigma::CoinDenomination::SIGMA_10)) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
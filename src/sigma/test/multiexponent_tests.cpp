@@ -0,0 +1,214 @@
+#include "../../secp256k1/include/MultiExponent.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace secp_primitives;
+
+namespace {
+
+// Above ECMULT_PIPPENGER_THRESHOLD whatever the endomorphism setting is
+const std::size_t PIPPENGER_SIZE = 300;
+
+GroupElement random_point() {
+    GroupElement p;
+    p.randomize();
+    return p;
+}
+
+// Doubling leaves a point with z != 1
+GroupElement jacobian_point() {
+    GroupElement p = random_point();
+    p.square();
+    return p;
+}
+
+GroupElement naive_multiple(const std::vector<GroupElement>& gens, const std::vector<Scalar>& powers) {
+    GroupElement result;
+    for (std::size_t i = 0; i < gens.size(); ++i)
+        result += gens[i] * powers[i];
+    return result;
+}
+
+void check_multiple(const std::vector<GroupElement>& gens, const std::vector<Scalar>& powers) {
+    GroupElement expected = naive_multiple(gens, powers);
+    BOOST_CHECK(MultiExponent(gens, powers).get_multiple() == expected);
+
+    std::vector<GroupElement> normalized(gens);
+    GroupElement::normalize(normalized);
+    BOOST_CHECK(MultiExponent(normalized, powers).get_multiple() == expected);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(sigma_multiexponent_tests)
+
+BOOST_AUTO_TEST_CASE(normalize_keeps_value)
+{
+    GroupElement p = jacobian_point();
+    GroupElement q(p);
+    BOOST_CHECK(q.normalize() == p);
+
+    GroupElement infinity;
+    BOOST_CHECK(infinity.normalize().isInfinity());
+
+    std::vector<GroupElement> points = {jacobian_point(), random_point(), GroupElement(), jacobian_point()};
+    std::vector<GroupElement> expected(points);
+    GroupElement::normalize(points);
+    BOOST_CHECK(points == expected);
+
+    std::vector<GroupElement> empty;
+    GroupElement::normalize(empty);
+    BOOST_CHECK(empty.empty());
+}
+
+BOOST_AUTO_TEST_CASE(add_to_all_matches_addition)
+{
+    for (const GroupElement& offset : {random_point(), jacobian_point(), GroupElement()}) {
+        std::vector<GroupElement> points;
+        for (int i = 0; i < 10; ++i)
+            points.push_back(i % 2 ? jacobian_point() : random_point());
+        points.push_back(GroupElement());
+        points.push_back(offset);
+        points.push_back(offset.inverse());
+
+        std::vector<GroupElement> expected(points);
+        for (GroupElement& p : expected)
+            p += offset;
+
+        GroupElement::add_to_all(points, offset);
+        BOOST_CHECK(points == expected);
+
+        // The infinity point picks up the offset, and -offset cancels it
+        BOOST_CHECK(points[10] == offset);
+        BOOST_CHECK(points.back().isInfinity());
+    }
+
+    // Doubling when the offset is one of the points
+    GroupElement p = random_point();
+    std::vector<GroupElement> points = {p};
+    GroupElement::add_to_all(points, p);
+    GroupElement doubled(p);
+    doubled.square();
+    BOOST_CHECK(points[0] == doubled);
+}
+
+BOOST_AUTO_TEST_CASE(multiple_matches_naive)
+{
+    // Sizes on both sides of the Strauss/Pippenger switch
+    for (std::size_t size : {std::size_t(1), std::size_t(2), std::size_t(16), PIPPENGER_SIZE}) {
+        std::vector<GroupElement> gens;
+        std::vector<Scalar> powers(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            gens.push_back(i % 2 ? jacobian_point() : random_point());
+            powers[i].randomize();
+        }
+        check_multiple(gens, powers);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(multiple_zero_and_infinity)
+{
+    for (std::size_t size : {std::size_t(16), PIPPENGER_SIZE}) {
+        std::vector<GroupElement> gens;
+        std::vector<Scalar> powers(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            gens.push_back(jacobian_point());
+            powers[i].randomize();
+        }
+
+        // Zero scalars and identity points drop out of the sum
+        for (std::size_t i = 0; i < size; i += 3)
+            powers[i] = Scalar(uint64_t(0));
+        for (std::size_t i = 1; i < size; i += 5)
+            gens[i] = GroupElement();
+        check_multiple(gens, powers);
+
+        // Nothing left to sum
+        std::vector<Scalar> zeros(size, Scalar(uint64_t(0)));
+        BOOST_CHECK(MultiExponent(gens, zeros).get_multiple().isInfinity());
+
+        std::vector<GroupElement> identities(size);
+        BOOST_CHECK(MultiExponent(identities, powers).get_multiple().isInfinity());
+    }
+
+    std::vector<GroupElement> no_gens;
+    std::vector<Scalar> no_powers;
+    BOOST_CHECK(MultiExponent(no_gens, no_powers).get_multiple().isInfinity());
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_matches_naive)
+{
+    std::vector<GroupElement> bases;
+    for (int i = 0; i < 20; ++i)
+        bases.push_back(i % 2 ? jacobian_point() : random_point());
+    FixedBaseTables tables(bases);
+    BOOST_CHECK(tables.covers(bases));
+
+    std::vector<Scalar> powers(bases.size());
+    for (Scalar& power : powers)
+        power.randomize();
+    BOOST_CHECK(MultiExponent(bases, powers, &tables).get_multiple() == naive_multiple(bases, powers));
+
+    // Zero scalars are skipped
+    powers[0] = Scalar(uint64_t(0));
+    powers[7] = Scalar(uint64_t(0));
+    BOOST_CHECK(MultiExponent(bases, powers, &tables).get_multiple() == naive_multiple(bases, powers));
+
+    std::vector<Scalar> zeros(bases.size(), Scalar(uint64_t(0)));
+    BOOST_CHECK(MultiExponent(bases, zeros, &tables).get_multiple().isInfinity());
+
+    // A prefix of the bases, as the sigma proofs use for smaller sets
+    std::vector<GroupElement> prefix(bases.begin(), bases.begin() + 5);
+    std::vector<Scalar> prefix_powers(powers.begin(), powers.begin() + 5);
+    BOOST_CHECK(tables.covers(prefix));
+    BOOST_CHECK(MultiExponent(prefix, prefix_powers, &tables).get_multiple() == naive_multiple(prefix, prefix_powers));
+
+    std::vector<GroupElement> no_gens;
+    std::vector<Scalar> no_powers;
+    BOOST_CHECK(tables.covers(no_gens));
+    BOOST_CHECK(MultiExponent(no_gens, no_powers, &tables).get_multiple().isInfinity());
+}
+
+BOOST_AUTO_TEST_CASE(fixed_base_falls_back)
+{
+    std::vector<GroupElement> bases;
+    for (int i = 0; i < 8; ++i)
+        bases.push_back(jacobian_point());
+    FixedBaseTables tables(bases);
+
+    std::vector<Scalar> powers(bases.size() + 1);
+    for (Scalar& power : powers)
+        power.randomize();
+
+    // More generators than bases
+    std::vector<GroupElement> longer(bases);
+    longer.push_back(random_point());
+    BOOST_CHECK(!tables.covers(longer));
+    BOOST_CHECK(MultiExponent(longer, powers, &tables).get_multiple() == naive_multiple(longer, powers));
+    powers.pop_back();
+
+    // Other generators, or the same points in another representation
+    std::vector<GroupElement> other(bases);
+    other[3] = random_point();
+    BOOST_CHECK(!tables.covers(other));
+    BOOST_CHECK(MultiExponent(other, powers, &tables).get_multiple() == naive_multiple(other, powers));
+
+    std::vector<GroupElement> normalized(bases);
+    GroupElement::normalize(normalized);
+    BOOST_CHECK(!tables.covers(normalized));
+    BOOST_CHECK(MultiExponent(normalized, powers, &tables).get_multiple() == naive_multiple(bases, powers));
+
+    // Tables stop at an identity base, only the bases before it are covered
+    std::vector<GroupElement> with_identity(bases);
+    with_identity[4] = GroupElement();
+    FixedBaseTables identity_tables(with_identity);
+    BOOST_CHECK(identity_tables.covers(std::vector<GroupElement>(with_identity.begin(), with_identity.begin() + 4)));
+    BOOST_CHECK(!identity_tables.covers(with_identity));
+    BOOST_CHECK(MultiExponent(with_identity, powers, &identity_tables).get_multiple() == naive_multiple(with_identity, powers));
+
+    FixedBaseTables empty_tables((std::vector<GroupElement>()));
+    BOOST_CHECK(!empty_tables.covers(bases));
+    BOOST_CHECK(MultiExponent(bases, powers, &empty_tables).get_multiple() == naive_multiple(bases, powers));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
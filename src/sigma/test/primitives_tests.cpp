@@ -1,3 +1,4 @@
+#include "../params.h"
 #include "../sigma_primitives.h"
 
 #include "../../secp256k1/include/GroupElement.h"
@@ -169,4 +170,34 @@ BOOST_AUTO_TEST_CASE(commit2_homomorphic_test)
     BOOST_CHECK(t1+t2 == t3);
 }
 
+BOOST_AUTO_TEST_CASE(commit2_fixed_base_test)
+{
+    // The tables of the default parameters don't change the commitment
+    const sigma::Params* params = sigma::Params::get_default();
+    const secp_primitives::GroupElement& g = params->get_g();
+
+    for (std::size_t size : {std::size_t(1), std::size_t(7), params->get_h().size()}) {
+        std::vector<secp_primitives::GroupElement> h_(params->get_h().begin(), params->get_h().begin() + size);
+        std::vector<secp_primitives::Scalar> x_(size);
+        for (secp_primitives::Scalar& x : x_)
+            x.randomize();
+        x_[0] = secp_primitives::Scalar(uint64_t(0));
+
+        secp_primitives::Scalar r;
+        r.randomize();
+
+        secp_primitives::GroupElement expected = g * r;
+        for (std::size_t i = 0; i < size; ++i)
+            expected += h_[i] * x_[i];
+
+        secp_primitives::GroupElement t1;
+        sigma::SigmaPrimitives<secp_primitives::Scalar,secp_primitives::GroupElement>::commit(g, h_, x_, r, t1);
+        secp_primitives::GroupElement t2;
+        sigma::SigmaPrimitives<secp_primitives::Scalar,secp_primitives::GroupElement>::commit(g, h_, x_, r, t2, params->get_h_tables());
+
+        BOOST_CHECK(t1 == expected);
+        BOOST_CHECK(t2 == expected);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,14 @@
 #include <secp256k1/include/Scalar.h>
 #include <secp256k1/include/GroupElement.h>
 
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+static_assert(std::is_trivially_copyable<secp_primitives::Scalar>::value, "Scalar is stored inline");
+static_assert(std::is_trivially_copyable<secp_primitives::GroupElement>::value, "GroupElement is stored inline");
+
 BOOST_AUTO_TEST_SUITE(sigma_primitive_types)
 
 BOOST_AUTO_TEST_CASE(scalar_test)
@@ -20,4 +28,225 @@ BOOST_AUTO_TEST_CASE(scalar_test)
     BOOST_CHECK(s == s2);
 }
 
+BOOST_AUTO_TEST_CASE(scalar_copy_test)
+{
+    secp_primitives::Scalar s;
+    s.randomize();
+
+    secp_primitives::Scalar copy(s);
+    secp_primitives::Scalar moved(std::move(copy));
+    BOOST_CHECK(moved == s);
+
+    secp_primitives::Scalar assigned;
+    assigned = moved;
+    BOOST_CHECK(assigned == s);
+    assigned = std::move(moved);
+    BOOST_CHECK(assigned == s);
+
+    // Changing a copy leaves the original alone
+    assigned += secp_primitives::Scalar(uint64_t(1));
+    BOOST_CHECK(assigned != s);
+
+    std::vector<secp_primitives::Scalar> v(100, s);
+    v.resize(1000);
+    BOOST_CHECK(v[99] == s);
+    BOOST_CHECK(v[999].isZero());
+}
+
+BOOST_AUTO_TEST_CASE(scalar_arithmetic_test)
+{
+    secp_primitives::Scalar zero(uint64_t(0));
+    secp_primitives::Scalar one(uint64_t(1));
+    BOOST_CHECK(secp_primitives::Scalar() == zero);
+    BOOST_CHECK(zero.isZero());
+    BOOST_CHECK(!one.isZero());
+
+    secp_primitives::Scalar a, b;
+    a.randomize();
+    b.randomize();
+
+    BOOST_CHECK(a + zero == a);
+    BOOST_CHECK(a * one == a);
+    BOOST_CHECK((a * zero).isZero());
+    BOOST_CHECK((a - a).isZero());
+    BOOST_CHECK((a + a.negate()).isZero());
+    BOOST_CHECK(a * a.inverse() == one);
+    BOOST_CHECK(a * b == b * a);
+    BOOST_CHECK((a + b) - b == a);
+    BOOST_CHECK(a.square() == a * a);
+    BOOST_CHECK(a.exponent(uint64_t(3)) == a * a * a);
+    BOOST_CHECK(secp_primitives::Scalar(uint64_t(6)) * secp_primitives::Scalar(uint64_t(7)) == secp_primitives::Scalar(uint64_t(42)));
+
+    // Equality compares the stored limbs, so results have to be reduced
+    secp_primitives::Scalar c(a);
+    c += b;
+    c -= b;
+    BOOST_CHECK(c == a);
+}
+
+BOOST_AUTO_TEST_CASE(scalar_serialize_test)
+{
+    secp_primitives::Scalar s;
+    s.randomize();
+
+    unsigned char buffer[32];
+    BOOST_CHECK(s.serialize(buffer) == buffer + s.memoryRequired());
+    secp_primitives::Scalar read;
+    read.deserialize(buffer);
+    BOOST_CHECK(read == s);
+}
+
+BOOST_AUTO_TEST_CASE(group_element_copy_test)
+{
+    secp_primitives::GroupElement g;
+    g.randomize();
+    g.square();
+
+    secp_primitives::GroupElement copy(g);
+    secp_primitives::GroupElement moved(std::move(copy));
+    BOOST_CHECK(moved == g);
+
+    secp_primitives::GroupElement assigned;
+    assigned = moved;
+    BOOST_CHECK(assigned == g);
+    assigned = std::move(moved);
+    BOOST_CHECK(assigned == g);
+
+    assigned += g;
+    BOOST_CHECK(assigned != g);
+
+    std::vector<secp_primitives::GroupElement> v(100, g);
+    v.resize(1000);
+    BOOST_CHECK(v[99] == g);
+    BOOST_CHECK(v[999].isInfinity());
+}
+
+BOOST_AUTO_TEST_CASE(group_element_serialize_test)
+{
+    secp_primitives::GroupElement g;
+    g.randomize();
+    g.square();
+
+    for (const secp_primitives::GroupElement& p : {g, secp_primitives::GroupElement()}) {
+        std::vector<unsigned char> buffer(p.memoryRequired());
+        BOOST_CHECK(p.serialize(buffer.data()) == buffer.data() + buffer.size());
+        secp_primitives::GroupElement read;
+        read.deserialize(buffer.data());
+        BOOST_CHECK(read == p);
+
+        unsigned char affine[secp_primitives::GroupElement::affine_size];
+        BOOST_CHECK(p.serialize_affine(affine) == affine + sizeof(affine));
+        secp_primitives::GroupElement read_affine;
+        BOOST_CHECK(read_affine.deserialize_affine(affine) == affine + sizeof(affine));
+        BOOST_CHECK(read_affine == p);
+        BOOST_CHECK(read_affine.isMember());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(group_element_invalid_affine_test)
+{
+    secp_primitives::GroupElement g;
+    g.randomize();
+    unsigned char valid[secp_primitives::GroupElement::affine_size];
+    g.serialize_affine(valid);
+
+    // A point off the curve
+    unsigned char buffer[secp_primitives::GroupElement::affine_size];
+    std::copy(valid, valid + sizeof(valid), buffer);
+    buffer[63] ^= 1;
+    secp_primitives::GroupElement read;
+    BOOST_CHECK_THROW(read.deserialize_affine(buffer), std::invalid_argument);
+
+    // A coordinate above the field size
+    std::copy(valid, valid + sizeof(valid), buffer);
+    std::fill(buffer, buffer + 32, 0xff);
+    BOOST_CHECK_THROW(read.deserialize_affine(buffer), std::invalid_argument);
+
+    // An infinity flag other than 0 or 1
+    std::copy(valid, valid + sizeof(valid), buffer);
+    buffer[64] = 2;
+    BOOST_CHECK_THROW(read.deserialize_affine(buffer), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(group_element_multiply_test)
+{
+    secp_primitives::GroupElement g;
+    g.randomize();
+
+    // Against repeated addition
+    secp_primitives::GroupElement sum;
+    for (int i = 1; i <= 20; ++i) {
+        sum += g;
+        BOOST_CHECK(g * secp_primitives::Scalar(uint64_t(i)) == sum);
+    }
+
+    secp_primitives::Scalar a, b;
+    a.randomize();
+    b.randomize();
+    BOOST_CHECK(g * (a + b) == g * a + g * b);
+    BOOST_CHECK(g * (a * b) == (g * a) * b);
+    BOOST_CHECK(g * a.negate() == (g * a).inverse());
+    BOOST_CHECK((g * secp_primitives::Scalar(uint64_t(0))).isInfinity());
+    BOOST_CHECK((secp_primitives::GroupElement() * a).isInfinity());
+
+    secp_primitives::GroupElement h(g);
+    h *= a;
+    BOOST_CHECK(h == g * a);
+}
+
+BOOST_AUTO_TEST_CASE(group_element_equality_test)
+{
+    secp_primitives::GroupElement g;
+    g.randomize();
+
+    // 2g in three representations
+    secp_primitives::GroupElement doubled(g);
+    doubled.square();
+    secp_primitives::GroupElement added = g + g;
+    secp_primitives::GroupElement normalized(doubled);
+    normalized.normalize();
+
+    for (const secp_primitives::GroupElement& p : {added, normalized}) {
+        BOOST_CHECK(p == doubled);
+        BOOST_CHECK(doubled == p);
+        BOOST_CHECK(!(p != doubled));
+        BOOST_CHECK(p.hash() == doubled.hash());
+    }
+
+    // The negation shares x, only the oddness of y tells them apart
+    BOOST_CHECK(doubled != doubled.inverse());
+    BOOST_CHECK(doubled.hash() != doubled.inverse().hash());
+    BOOST_CHECK(doubled != g);
+
+    secp_primitives::GroupElement infinity;
+    secp_primitives::GroupElement sum = doubled + doubled.inverse();
+    BOOST_CHECK(sum.isInfinity());
+    BOOST_CHECK(sum == infinity);
+    BOOST_CHECK(sum.hash() == infinity.hash());
+    BOOST_CHECK(infinity != g);
+    BOOST_CHECK(g != infinity);
+}
+
+BOOST_AUTO_TEST_CASE(group_element_hash_set_test)
+{
+    std::vector<secp_primitives::GroupElement> points(200);
+    std::unordered_set<secp_primitives::GroupElement> set;
+    for (secp_primitives::GroupElement& p : points) {
+        p.randomize();
+        p.square();
+        secp_primitives::GroupElement normalized(p);
+        set.insert(normalized.normalize());
+    }
+    set.insert(secp_primitives::GroupElement());
+    BOOST_CHECK(set.size() == points.size() + 1);
+
+    // Found whatever representation the key has
+    for (const secp_primitives::GroupElement& p : points) {
+        BOOST_CHECK(set.count(p) == 1);
+        BOOST_CHECK(set.count(p + p.inverse() + p) == 1);
+        BOOST_CHECK(set.count(p.inverse()) == 0);
+    }
+    BOOST_CHECK(set.count(points[0] + points[0].inverse()) == 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
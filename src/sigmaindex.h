@@ -0,0 +1,47 @@
+// Copyright (c) 2019 The NIX Core Developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef NIX_SIGMAINDEX_H
+#define NIX_SIGMAINDEX_H
+
+#include "uint256.h"
+#include "serialize.h"
+
+// Location of a sigma mint in the active chain, indexed by the hash of its pubcoin value
+struct CSigmaMintIndexValue {
+    uint256 txid;
+    unsigned int outputIndex;
+    int blockHeight;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(txid);
+        READWRITE(outputIndex);
+        READWRITE(blockHeight);
+    }
+
+    CSigmaMintIndexValue(uint256 t, unsigned int i, int h) {
+        txid = t;
+        outputIndex = i;
+        blockHeight = h;
+    }
+
+    CSigmaMintIndexValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        txid.SetNull();
+        outputIndex = 0;
+        blockHeight = 0;
+    }
+
+    bool IsNull() const {
+        return txid.IsNull();
+    }
+};
+
+#endif // NIX_SIGMAINDEX_H
@@ -31,6 +31,8 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_TIMESTAMPINDEX = 's';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_BLOCKHASHINDEX = 'z';
+static const char DB_SIGMAMINTINDEX = 'g';
+static const char DB_PRIVACYSTATSINDEX = 'q';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
@@ -271,6 +273,34 @@ bool CBlockTreeDB::UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey,
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ReadSigmaMintIndex(const uint256 &pubCoinValueHash, CSigmaMintIndexValue &value) {
+    return Read(make_pair(DB_SIGMAMINTINDEX, pubCoinValueHash), value);
+}
+
+bool CBlockTreeDB::UpdateSigmaMintIndex(const std::vector<std::pair<uint256, CSigmaMintIndexValue> > &vect) {
+    CDBBatch batch(*this);
+    for (std::vector<std::pair<uint256, CSigmaMintIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(make_pair(DB_SIGMAMINTINDEX, it->first));
+        } else {
+            batch.Write(make_pair(DB_SIGMAMINTINDEX, it->first), it->second);
+        }
+    }
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::ReadPrivacyStatsIndex(int nHeight, CPrivacyStatsIndexValue &value) {
+    return Read(make_pair(DB_PRIVACYSTATSINDEX, nHeight), value);
+}
+
+bool CBlockTreeDB::WritePrivacyStatsIndex(int nHeight, const CPrivacyStatsIndexValue &value) {
+    return Write(make_pair(DB_PRIVACYSTATSINDEX, nHeight), value);
+}
+
+bool CBlockTreeDB::ErasePrivacyStatsIndex(int nHeight) {
+    return Erase(make_pair(DB_PRIVACYSTATSINDEX, nHeight));
+}
+
 bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
@@ -442,13 +472,9 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
                 pindexNew->nTx            = diskindex.nTx;
 
                 //zerocoin
-                pindexNew->accumulatorChanges = diskindex.accumulatorChanges;
-                pindexNew->mintedPubCoins     = diskindex.mintedPubCoins;
-                pindexNew->spentSerials       = diskindex.spentSerials;
+                pindexNew->privacyData    = std::move(diskindex.privacyData);
 
-                pindexNew->accumulatorChangesV2 = diskindex.accumulatorChangesV2;
-                pindexNew->mintedPubCoinsV2     = diskindex.mintedPubCoinsV2;
-                pindexNew->spentSerialsV2       = diskindex.spentSerialsV2;
+                pindexNew->nCycleGhostedValue = diskindex.nCycleGhostedValue;
 
                 //PoS
                 if(diskindex.IsProofOfStake() || diskindex.nHeight >= Params().GetConsensus().nPosHeightActivate){
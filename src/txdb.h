@@ -16,6 +16,8 @@
 #include <vector>
 #include <spentindex.h>
 #include <addressindex.h>
+#include <sigmaindex.h>
+#include <privacystatsindex.h>
 
 class CBlockIndex;
 class CCoinsViewDBCursor;
@@ -124,6 +126,11 @@ public:
     bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &vect);
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
+    bool ReadSigmaMintIndex(const uint256 &pubCoinValueHash, CSigmaMintIndexValue &value);
+    bool UpdateSigmaMintIndex(const std::vector<std::pair<uint256, CSigmaMintIndexValue> > &vect);
+    bool ReadPrivacyStatsIndex(int nHeight, CPrivacyStatsIndexValue &value);
+    bool WritePrivacyStatsIndex(int nHeight, const CPrivacyStatsIndexValue &value);
+    bool ErasePrivacyStatsIndex(int nHeight);
     bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
     bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
     bool ReadAddressUnspentIndex(uint256 addressHash, int type,
@@ -15,6 +15,7 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <cuckoocache.h>
+#include <executor.h>
 #include <hash.h>
 #include <init.h>
 #include <policy/fees.h>
@@ -344,6 +345,9 @@ bool fEnableReplacement = DEFAULT_ENABLE_REPLACEMENT;
 bool fAddressIndex = false;
 bool fSpentIndex = false;
 bool fTimestampIndex = false;
+bool fSigmaIndex = false;
+bool fPrivacyStatsIndex = false;
+bool fZerocoinVerifyParallel = DEFAULT_ZEROCOIN_VERIFY_PARALLEL;
 bool fDisableZerocoinTransactions = true;
 
 /*****NIX Data Index*******/
@@ -411,6 +415,10 @@ std::unique_ptr<CCoinsViewDB> pcoinsdbview;
 std::unique_ptr<CCoinsViewCache> pcoinsTip;
 std::unique_ptr<CBlockTreeDB> pblocktree;
 
+//! Set while the zerocoin and sigma state lag behind the chain tip loaded at startup, until
+//! VerifyDB() restores it. No snapshot of the state is written in the meantime.
+static bool fPrivacyStateStale = false;
+
 enum FlushStateMode {
     FLUSH_STATE_NONE,
     FLUSH_STATE_IF_NEEDED,
@@ -1184,9 +1192,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                 }
                 // add input denoms
                 for(int i = 0; i < tx.vin.size(); i++){
-                    std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                    newSpend = ParseSigmaSpend(tx.vin[i]);
-                    inVal += newSpend.first->getIntDenomination();
+                    inVal += ParseSigmaSpendHeader(tx.vin[i]).getIntDenomination();
                 }
 
                 nFees = inVal - outVal;
@@ -2152,6 +2158,12 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+void InitScriptCheckQueue(int nHelpers) {
+    scriptcheckqueue.SetHelpers(nHelpers, [](std::function<void()> helper) {
+        GetComputeExecutor().Post(std::move(helper));
+    });
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -2231,11 +2243,166 @@ static unsigned int GetBlockScriptFlags(const CBlockIndex* pindex, const Consens
     return flags;
 }
 
+/** Value a block adds to the ghost fee pool: its ghosted mints and the fee equivalent of its ckp transactions */
+static CAmount GetBlockGhostedValue(const CBlock &block)
+{
+    CAmount nGhosted = 0;
+    for(auto ctx: block.vtx){
+        bool isSpend = ctx->IsZerocoinSpend() || ctx->IsSigmaSpend();
+        bool isMint = ctx->IsZerocoinMint() || ctx->IsSigmaMint();
+        //Found ghost fee transaction
+        if(!isSpend && isMint){
+            for(auto mintTx: ctx->vout){
+                if(mintTx.scriptPubKey.IsZerocoinMint() || mintTx.scriptPubKey.IsSigmaMint())
+                    nGhosted += mintTx.nValue;
+            }
+        }
+        //ckp tx requires 0.1 fee, but calculate the fee on a dynamic basis
+        if(ctx->IsSigmaSpend() && isMint){
+            CAmount inVal = 0;
+            CAmount outVal = 0;
+            for(int i = 0; i < ctx->vout.size(); i++){
+                if(!ctx->vout[i].scriptPubKey.IsSigmaMint())
+                    continue;
+                outVal += ctx->vout[i].nValue;
+            }
+            // add input denoms
+            for(int i = 0; i < ctx->vin.size(); i++){
+                inVal += ParseSigmaSpendHeader(ctx->vin[i]).getIntDenomination();
+            }
+            CAmount neededForFee = (inVal - outVal)/0.0025;
+            nGhosted += neededForFee;
+        }
+    }
+    return nGhosted;
+}
+
+/** Whether a block is the first one sampled for the ghost fee payout at the end of its cycle */
+static bool IsGhostFeeCycleStart(int nHeight)
+{
+    return (nHeight - 1) % Params().GetConsensus().nGhostFeeDistributionCycle == 0;
+}
+
+static bool GetCycleGhostedValue(CBlockIndex *pindex, CAmount &nGhosted);
+
+/** Add the ghosted value of block to the running total of its cycle kept in pindex */
+static bool SetCycleGhostedValue(CBlockIndex *pindex, const CBlock &block)
+{
+    AssertLockHeld(cs_main);
+
+    CAmount nPrevious = 0;
+    if (pindex->pprev && !IsGhostFeeCycleStart(pindex->nHeight) && !GetCycleGhostedValue(pindex->pprev, nPrevious))
+        return false;
+
+    pindex->nCycleGhostedValue = nPrevious + GetBlockGhostedValue(block);
+    if (!(pindex->nStatus & BLOCK_HAVE_GHOSTED)) {
+        pindex->nStatus |= BLOCK_HAVE_GHOSTED;
+        setDirtyBlockIndex.insert(pindex);
+    }
+    return true;
+}
+
+/**
+ * Running ghosted value of the cycle up to and including pindex. Blocks
+ * connected before the total was tracked are read from disk once, back to
+ * the start of the cycle.
+ */
+static bool GetCycleGhostedValue(CBlockIndex *pindex, CAmount &nGhosted)
+{
+    AssertLockHeld(cs_main);
+
+    std::vector<CBlockIndex*> vMissing;
+    for (CBlockIndex *pwalk = pindex; pwalk && !(pwalk->nStatus & BLOCK_HAVE_GHOSTED); pwalk = pwalk->pprev) {
+        vMissing.push_back(pwalk);
+        if (IsGhostFeeCycleStart(pwalk->nHeight))
+            break;
+    }
+
+    for (auto it = vMissing.rbegin(); it != vMissing.rend(); ++it) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, *it, Params().GetConsensus()) || !SetCycleGhostedValue(*it, block))
+            return false;
+    }
+
+    nGhosted = pindex->nCycleGhostedValue;
+    return true;
+}
+
+/** Add the privacy statistics of a block to the totals of the blocks before it */
+static void AddPrivacyStats(const CBlock &block, CPrivacyStatsIndexValue &value)
+{
+    for (const CTransactionRef &ctx : block.vtx) {
+        bool fZerocoinMint = ctx->IsZerocoinMint();
+        bool fZerocoinSpend = ctx->IsZerocoinSpend();
+        bool fSigmaMint = ctx->IsSigmaMint();
+        bool fSigmaSpend = ctx->IsSigmaSpend();
+        if (!fZerocoinMint && !fZerocoinSpend && !fSigmaMint && !fSigmaSpend)
+            continue;
+
+        for (const CTxOut &out : ctx->vout) {
+            for (int i = 0; i < PRIVACY_STATS_ZEROCOIN_DENOMS; i++) {
+                if (out.nValue != PRIVACY_STATS_ZEROCOIN_VALUES[i])
+                    continue;
+                if (fZerocoinMint && out.scriptPubKey.IsZerocoinMint())
+                    value.zerocoinMints[i]++;
+                if (fZerocoinSpend)
+                    value.zerocoinSpends[i]++;
+            }
+            for (int i = 0; i < PRIVACY_STATS_SIGMA_DENOMS; i++) {
+                if (out.nValue != PRIVACY_STATS_SIGMA_VALUES[i])
+                    continue;
+                if (fSigmaMint && out.scriptPubKey.IsSigmaMint())
+                    value.sigmaMints[i]++;
+                if (fSigmaSpend)
+                    value.sigmaSpends[i]++;
+            }
+        }
+    }
+
+    value.ghostedValue += GetBlockGhostedValue(block);
+    if (!block.vtx.empty() && !block.vtx[0]->vout.empty())
+        value.stakeValue += block.vtx[0]->vout[0].nValue;
+}
+
+/**
+ * Write the privacy statistics totals up to the block at pindex, from those of the block before it.
+ * Entries missing before it, such as those of blocks connected after the last flush of an unclean
+ * shutdown, are recomputed from their blocks first.
+ */
+static bool WritePrivacyStatsIndex(const CBlock &block, const CBlockIndex *pindex)
+{
+    // The genesis block is never connected and counts as empty
+    CPrivacyStatsIndexValue value;
+    std::vector<const CBlockIndex*> vMissing;
+    for (const CBlockIndex *pindexPrev = pindex->pprev; pindexPrev && pindexPrev->nHeight > 0; pindexPrev = pindexPrev->pprev) {
+        CPrivacyStatsIndexValue prevValue;
+        if (pblocktree->ReadPrivacyStatsIndex(pindexPrev->nHeight, prevValue)) {
+            value = prevValue;
+            break;
+        }
+        vMissing.push_back(pindexPrev);
+    }
+
+    for (auto it = vMissing.rbegin(); it != vMissing.rend(); ++it) {
+        CBlock blockMissing;
+        if (!ReadBlockFromDisk(blockMissing, *it, Params().GetConsensus()))
+            return error("%s: failed to read block %s", __func__, (*it)->GetBlockHash().ToString());
+        AddPrivacyStats(blockMissing, value);
+        if (!pblocktree->WritePrivacyStatsIndex((*it)->nHeight, value))
+            return false;
+    }
+    if (!vMissing.empty())
+        LogPrintf("%s: recomputed the privacy statistics of %u blocks below height %d\n", __func__, vMissing.size(), pindex->nHeight);
+
+    AddPrivacyStats(block, value);
+    return pblocktree->WritePrivacyStatsIndex(pindex->nHeight, value);
+}
+
 bool GetGhostnodeFeePayment(int64_t &returnFee, bool &payFees, const CBlock &pBlock){
 
+    LOCK(cs_main);
+
     CAmount totalGhosted = 0;
-    vector<CAmount> mintVector;
-    mintVector.clear();
     if(chainActive.Height() + 1 >= Params().GetConsensus().nStartGhostFeeDistribution){
         //Time to payout all ghostnodes and check
         //LogPrintf("\nGetGhostnodeFeePayment(): height=%d, modulo=%d\n",
@@ -2243,81 +2410,18 @@ bool GetGhostnodeFeePayment(int64_t &returnFee, bool &payFees, const CBlock &pBl
         if(((chainActive.Height() + 1) % Params().GetConsensus().nGhostFeeDistributionCycle) == 0){
             //Subtract 1 from sample since we check current block fees
             int sample = Params().GetConsensus().nGhostFeeDistributionCycle - 1;
-            mintVector.clear();
 
-            //Assume chainactive+1 is current block check height
-            int startHeight = chainActive.Height() + 1 - sample;
             //Grab fee from current block being checked
-            for(auto ctx: pBlock.vtx){
-                bool isSpend = ctx->IsZerocoinSpend() || ctx->IsSigmaSpend();
-                bool isMint = ctx->IsZerocoinMint() || ctx->IsSigmaMint();
-                //Found ghost fee transaction
-                if(!isSpend && isMint){
-                    for(auto mintTx: ctx->vout){
-                        if(mintTx.scriptPubKey.IsZerocoinMint() || mintTx.scriptPubKey.IsSigmaMint())
-                            mintVector.push_back(mintTx.nValue);
-                    }
-                }
-                //ckp tx requires 0.1 fee, but calculate the fee on a dynamic basis
-                if(ctx->IsSigmaSpend() && isMint){
-                    CAmount inVal = 0;
-                    CAmount outVal = 0;
-                    for(int i = 0; i < ctx->vout.size(); i++){
-                        if(!ctx->vout[i].scriptPubKey.IsSigmaMint())
-                            continue;
-                        outVal += ctx->vout[i].nValue;
-                    }
-                    // add input denoms
-                    for(int i = 0; i < ctx->vin.size(); i++){
-                        std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                        newSpend = ParseSigmaSpend(ctx->vin[i]);
-                        inVal += newSpend.first->getIntDenomination();
-                    }
-                    CAmount neededForFee = (inVal - outVal)/0.0025;
-                    mintVector.push_back(neededForFee);
-                }
-            }
-            //Grab fee from other blocks
-            for(auto it = startHeight; it < chainActive.Height() + 1; it++){
-                CBlock block;
-                CBlockIndex *pindex = chainActive[it];
-                // Now get fees from past 719 blocks
-                if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())){
-                    for(auto ctx: block.vtx){
-                        bool isSpend = ctx->IsZerocoinSpend() || ctx->IsSigmaSpend();
-                        bool isMint = ctx->IsZerocoinMint() || ctx->IsSigmaMint();
-                        //Found ghost fee transaction
-                        if(!isSpend && isMint){
-                            for(auto mintTx: ctx->vout){
-                                if(mintTx.scriptPubKey.IsZerocoinMint() || mintTx.scriptPubKey.IsSigmaMint())
-                                    mintVector.push_back(mintTx.nValue);
-                            }
-                        }
-                        //ckp tx requires 0.1 fee, but calculate the fee on a dynamic basis
-                        if(ctx->IsSigmaSpend() && isMint){
-                            CAmount inVal = 0;
-                            CAmount outVal = 0;
-                            for(int i = 0; i < ctx->vout.size(); i++){
-                                if(!ctx->vout[i].scriptPubKey.IsSigmaMint())
-                                    continue;
-                                outVal += ctx->vout[i].nValue;
-                            }
-                            // add input denoms
-                            for(int i = 0; i < ctx->vin.size(); i++){
-                                std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                                newSpend = ParseSigmaSpend(ctx->vin[i]);
-                                inVal += newSpend.first->getIntDenomination();
-                            }
-                            CAmount neededForFee = (inVal - outVal)/0.0025;
-                            mintVector.push_back(neededForFee);
-                        }
-                    }
-                }
-                else
+            totalGhosted += GetBlockGhostedValue(pBlock);
+
+            //Grab fee from the other blocks of the cycle, kept as a running total in the block index
+            if(sample > 0){
+                CAmount cycleGhosted = 0;
+                if(!GetCycleGhostedValue(chainActive.Tip(), cycleGhosted))
                     return false;
+                totalGhosted += cycleGhosted;
             }
-            for(auto f: mintVector)
-                totalGhosted += f;
+
             //Calculate total fees for the 720 block cycle
             returnFee = totalGhosted * 0.0025;
             payFees = true;
@@ -2325,38 +2429,7 @@ bool GetGhostnodeFeePayment(int64_t &returnFee, bool &payFees, const CBlock &pBl
         }
         //Make sure all ghost fees in this block are not paid out
         else{
-            for(auto ctx: pBlock.vtx){
-                bool isSpend = ctx->IsZerocoinSpend() || ctx->IsSigmaSpend();
-                bool isMint = ctx->IsZerocoinMint() || ctx->IsSigmaMint();
-                //Found ghost fee transaction
-                if(!isSpend && isMint){
-                    for(auto mintTx: ctx->vout){
-                        if(mintTx.scriptPubKey.IsZerocoinMint() || mintTx.scriptPubKey.IsSigmaMint())
-                            mintVector.push_back(mintTx.nValue);
-                    }
-                }
-                //ckp tx requires 0.1 fee, but calculate the fee on a dynamic basis
-                if(ctx->IsSigmaSpend() && isMint){
-                    CAmount inVal = 0;
-                    CAmount outVal = 0;
-                    for(int i = 0; i < ctx->vout.size(); i++){
-                        if(!ctx->vout[i].scriptPubKey.IsSigmaMint())
-                            continue;
-                        outVal += ctx->vout[i].nValue;
-                    }
-                    // add input denoms
-                    for(int i = 0; i < ctx->vin.size(); i++){
-                        std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                        newSpend = ParseSigmaSpend(ctx->vin[i]);
-                        inVal += newSpend.first->getIntDenomination();
-                    }
-                    CAmount neededForFee = (inVal - outVal)/0.0025;
-                    mintVector.push_back(neededForFee);
-                }
-            }
-
-            for(auto f: mintVector)
-                totalGhosted += f;
+            totalGhosted += GetBlockGhostedValue(pBlock);
             //Calculate total fees for the current block
             returnFee = totalGhosted * 0.0025;
             payFees = false;
@@ -2375,37 +2448,21 @@ bool CheckGhostProtocolFeePayouts(const CBlock &pBlock, int64_t &totalFees){
     //If current node is synced with node list, check honesty of payouts
     if(ghostnodeSync.IsSynced() && totalFees != 0){
 
-        vector<CGhostnode> ghostnodeVector = mnodeman.GetFullGhostnodeVector();
-        vector<CScript> ghostnodeVectorWinners;
-        ghostnodeVectorWinners.clear();
-
-        int totalActiveNodes = 0;
         int startBlock = (chainActive.Height() + 1) - (Params().GetConsensus().nGhostFeeDistributionCycle - 1);
         int64_t ensureNodeActiveBefore = chainActive[startBlock]->GetBlockTime();
 
-        for(auto node: ghostnodeVector){
-
-            if(node.IsEnabled() && (node.sigTime <= ensureNodeActiveBefore)){
-                totalActiveNodes++;
-                CTxDestination dest = node.pubKeyCollateralAddress.GetID();
-                CScript nodeScript = GetScriptForDestination(dest);
-                ghostnodeVectorWinners.push_back(nodeScript);
-            }
+        CGhostFeePayeesRef payees = mnodeman.GetGhostFeePayees(chainActive.Tip()->GetBlockHash(), ensureNodeActiveBefore);
+        int totalActiveNodes = payees->GetCount();
+        if(totalActiveNodes == 0){
+            return true;
         }
 
         CAmount feePayout = totalFees/totalActiveNodes;
-        int totalNodesPaid = 0;
         if(feePayout == 0){
             return true;
         }
 
-        for(CTxOut out: pBlock.vtx[0]->vout){
-            if((std::find(ghostnodeVectorWinners.begin(), ghostnodeVectorWinners.end(), out.scriptPubKey) != ghostnodeVectorWinners.end()) && out.nValue == feePayout) {
-                //erase this check to prevent duplicate payouts
-                ghostnodeVectorWinners.erase(std::find(ghostnodeVectorWinners.begin(), ghostnodeVectorWinners.end(), out.scriptPubKey));
-                totalNodesPaid++;
-            }
-        }
+        int totalNodesPaid = payees->CountPaid(pBlock.vtx[0]->vout, feePayout);
 
         if(totalNodesPaid != totalActiveNodes){
             LogPrintf("\nCheckGhostProtocolFeePayouts(): Paid out incorrect amount of nodes: actual: %i, estimate: %i \n", totalNodesPaid, totalActiveNodes);
@@ -2513,6 +2570,39 @@ bool CheckRequiredInputAmounts(const CBlock &block, int nHeight, CValidationStat
     return true;
 }
 
+/** Whether the block is an ancestor of the -assumevalid block that is buried deep enough
+ *  for its script and zerocoin proof checks to be skipped. */
+static bool IsBlockAssumedValid(const CBlockIndex* pindex, const Consensus::Params& consensusParams)
+{
+    AssertLockHeld(cs_main);
+    if (!hashAssumeValid.IsNull()) {
+        // We've been configured with the hash of a block which has been externally verified to have a valid history.
+        // A suitable default value is included with the software and updated from time to time.  Because validity
+        //  relative to a piece of software is an objective fact these defaults can be easily reviewed.
+        // This setting doesn't force the selection of any particular chain but makes validating some faster by
+        //  effectively caching the result of part of the verification.
+        BlockMap::const_iterator  it = mapBlockIndex.find(hashAssumeValid);
+        if (it != mapBlockIndex.end()) {
+            if (it->second->GetAncestor(pindex->nHeight) == pindex &&
+                pindexBestHeader->GetAncestor(pindex->nHeight) == pindex &&
+                pindexBestHeader->nChainWork >= nMinimumChainWork) {
+                // This block is a member of the assumed verified chain and an ancestor of the best header.
+                // The equivalent time check discourages hash power from extorting the network via DOS attack
+                //  into accepting an invalid block through telling users they must manually set assumevalid.
+                //  Requiring a software change or burying the invalid block, regardless of the setting, makes
+                //  it hard to hide the implication of the demand.  This also avoids having release candidates
+                //  that are hardly doing any signature verification at all in testing without having to
+                //  artificially set the default assumed verified block further back.
+                // The test against nMinimumChainWork prevents the skipping when denied access to any chain at
+                //  least as good as the expected chain.
+                return GetBlockProofEquivalentTime(*pindexBestHeader, *pindex, *pindexBestHeader, consensusParams) > 60 * 60 * 24 * 7 * 2;
+            }
+        }
+    }
+
+    return false;
+}
+
 static int64_t nTimeCheck = 0;
 static int64_t nTimeForks = 0;
 static int64_t nTimeVerify = 0;
@@ -2578,31 +2668,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
 
     nBlocksTotal++;
 
-    bool fScriptChecks = true;
-    if (!hashAssumeValid.IsNull()) {
-        // We've been configured with the hash of a block which has been externally verified to have a valid history.
-        // A suitable default value is included with the software and updated from time to time.  Because validity
-        //  relative to a piece of software is an objective fact these defaults can be easily reviewed.
-        // This setting doesn't force the selection of any particular chain but makes validating some faster by
-        //  effectively caching the result of part of the verification.
-        BlockMap::const_iterator  it = mapBlockIndex.find(hashAssumeValid);
-        if (it != mapBlockIndex.end()) {
-            if (it->second->GetAncestor(pindex->nHeight) == pindex &&
-                pindexBestHeader->GetAncestor(pindex->nHeight) == pindex &&
-                pindexBestHeader->nChainWork >= nMinimumChainWork) {
-                // This block is a member of the assumed verified chain and an ancestor of the best header.
-                // The equivalent time check discourages hash power from extorting the network via DOS attack
-                //  into accepting an invalid block through telling users they must manually set assumevalid.
-                //  Requiring a software change or burying the invalid block, regardless of the setting, makes
-                //  it hard to hide the implication of the demand.  This also avoids having release candidates
-                //  that are hardly doing any signature verification at all in testing without having to
-                //  artificially set the default assumed verified block further back.
-                // The test against nMinimumChainWork prevents the skipping when denied access to any chain at
-                //  least as good as the expected chain.
-                fScriptChecks = (GetBlockProofEquivalentTime(*pindexBestHeader, *pindex, *pindexBestHeader, chainparams.GetConsensus()) <= 60 * 60 * 24 * 7 * 2);
-            }
-        }
-    }
+    bool fScriptChecks = !IsBlockAssumedValid(pindex, chainparams.GetConsensus());
 
     int64_t nTime1 = GetTimeMicros(); nTimeCheck += nTime1 - nTimeStart;
     LogPrint(BCLog::BENCH, "    - Sanity checks: %.2fms [%.2fs (%.2fms/blk)]\n", MILLI * (nTime1 - nTimeStart), nTimeCheck * MICRO, nTimeCheck * MILLI / nBlocksTotal);
@@ -2694,9 +2760,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
             }
             // add input denoms
             for(int i = 0; i < tx.vin.size(); i++){
-                std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                newSpend = ParseSigmaSpend(tx.vin[i]);
-                inVal += newSpend.first->getIntDenomination();
+                inVal += ParseSigmaSpendHeader(tx.vin[i]).getIntDenomination();
             }
             nFees += (inVal - outVal);
         }
@@ -2928,7 +2992,7 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     if (!ConnectBlockGhost(state, chainparams, pindex, &block))
         return false;
 
-    if (!ConnectBlockSigma(state, chainparams, pindex, &block))
+    if (!ConnectBlockSigma(state, chainparams, pindex, &block, fJustCheck))
         return false;
 
     //Set money supply on block once PoS starts, calculate previous total
@@ -2945,6 +3009,13 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     if (fJustCheck)
         return true;
 
+    // Left unset if earlier blocks of the cycle cannot be read, the payout
+    // then fails the same way
+    SetCycleGhostedValue(pindex, block);
+
+    if (fPrivacyStatsIndex && !WritePrivacyStatsIndex(block, pindex))
+        return AbortNode(state, "Failed to write privacy statistics index");
+
     if (!WriteUndoDataForBlock(blockundo, state, pindex, chainparams))
         return false;
 
@@ -3124,6 +3195,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // Snapshot the zerocoin and sigma state matching the flushed chainstate, for a fast restart.
+            if (!fPrivacyStateStale)
+                DumpPrivacyState(pcoinsTip->GetBestBlock());
             nLastFlush = nNow;
         }
     }
@@ -3287,7 +3361,11 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
 
     DisconnectTipGhost(block, pindexDelete);
 
-    DisconnectTipSigma(block, pindexDelete);
+    if (!DisconnectTipSigma(block, pindexDelete))
+        return AbortNode(state, "Failed to update sigma mint index");
+
+    if (fPrivacyStatsIndex && !pblocktree->ErasePrivacyStatsIndex(pindexDelete->nHeight))
+        return AbortNode(state, "Failed to update privacy statistics index");
 
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
@@ -4224,9 +4302,27 @@ bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::P
     if (block.zerocoinTxInfo == NULL)
         block.zerocoinTxInfo = std::make_shared<CZerocoinTxInfo>();
 
+    // Zerocoin spend proofs below -assumevalid are not verified, their serials are still recorded
+    if (!isVerifyDB) {
+        LOCK(cs_main);
+        BlockMap::const_iterator mi = mapBlockIndex.find(block.GetHash());
+        block.zerocoinTxInfo->fCheckProofs = mi == mapBlockIndex.end() || !IsBlockAssumedValid(mi->second, consensusParams);
+    }
+
     if (block.sigmaTxInfo == NULL)
         block.sigmaTxInfo = std::make_shared<CSigmaTxInfo>();
 
+    // Spends are queued while the transactions are checked and verified at the end. Make sure
+    // nothing queued by an earlier, failed check of this block is left behind, and that the
+    // spends queued now are dropped whichever way this check returns.
+    struct CSpendBatchReset {
+        CSigmaSpendBatch &sigmaBatch;
+        CZerocoinSpendBatch &zerocoinBatch;
+        void Clear() { sigmaBatch.Clear(); zerocoinBatch.Clear(); }
+        ~CSpendBatchReset() { Clear(); }
+    } spendBatchReset{block.sigmaTxInfo->spendBatch, block.zerocoinTxInfo->spendBatch};
+    spendBatchReset.Clear();
+
     // Check transactions
     for (const auto& tx : block.vtx){
         if (!CheckTransaction(*tx, state, tx->GetHash(), isVerifyDB, true, nHeight, false, block.zerocoinTxInfo.get(), block.sigmaTxInfo.get())){
@@ -4235,6 +4331,14 @@ bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::P
         }
     }
 
+    // Verify the proofs of all the sigma spends of the block together
+    if (!block.sigmaTxInfo->spendBatch.Verify(nHeight))
+        return state.Invalid(false, REJECT_INVALID, "bad-txns-sigma-spend-proof", "Sigma spend verification failed");
+
+    // Verify the proofs of the zerocoin spends left for the end of the block by -zcverifyparallel
+    if (!block.zerocoinTxInfo->spendBatch.Verify(nHeight))
+        return state.Invalid(false, REJECT_INVALID, "bad-txns-zerocoin-spend-proof", "Zerocoin spend verification failed");
+
     block.zerocoinTxInfo->Complete();
     block.sigmaTxInfo->Complete();
 
@@ -5114,6 +5218,14 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("dataindex", fDataIndex);
     LogPrintf("%s: data index %s\n", __func__, fDataIndex ? "enabled" : "disabled");
 
+    // Check whether we have a sigma mint index
+    pblocktree->ReadFlag("sigmaindex", fSigmaIndex);
+    LogPrintf("%s: sigma mint index %s\n", __func__, fSigmaIndex ? "enabled" : "disabled");
+
+    // Check whether we have a privacy statistics index
+    pblocktree->ReadFlag("privacystatsindex", fPrivacyStatsIndex);
+    LogPrintf("%s: privacy statistics index %s\n", __func__, fPrivacyStatsIndex ? "enabled" : "disabled");
+
     // some blocks in index can change as a result of ZerocoinBuildStateFromIndex() call
     set<CBlockIndex *> changes;
     ZerocoinBuildStateFromIndex(&chainActive, changes);
@@ -5145,6 +5257,7 @@ bool LoadChainTip(const CChainParams& chainparams)
     if (it == mapBlockIndex.end())
         return false;
     chainActive.SetTip(it->second);
+    fPrivacyStateStale = true;
 
     g_chainstate.PruneBlockIndexCandidates();
 
@@ -5253,16 +5366,21 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
         }
     }
 
-    // some blocks in index can change as a result of ZerocoinBuildStateFromIndex() call
-    set<CBlockIndex *> changes;
-    ZerocoinBuildStateFromIndex(&chainActive, changes);
-    if (!changes.empty()) {
-        setDirtyBlockIndex.insert(changes.begin(), changes.end());
-        FlushStateToDisk();
-    }
+    // Restore the zerocoin and sigma state from the snapshot written at the last flush, and only
+    // replay the block index if there is none for this tip
+    if (!LoadPrivacyState(chainActive)) {
+        // some blocks in index can change as a result of ZerocoinBuildStateFromIndex() call
+        set<CBlockIndex *> changes;
+        ZerocoinBuildStateFromIndex(&chainActive, changes);
+        if (!changes.empty()) {
+            setDirtyBlockIndex.insert(changes.begin(), changes.end());
+            FlushStateToDisk();
+        }
 
-    if(!SigmaBuildStateFromIndex(&chainActive))
-        return error("VerifyDB(): *** SigmaBuildStateFromIndex error \n");
+        if(!SigmaBuildStateFromIndex(&chainActive))
+            return error("VerifyDB(): *** SigmaBuildStateFromIndex error \n");
+    }
+    fPrivacyStateStale = false;
 
     LogPrintf("[DONE].\n");
     LogPrintf("No coin database inconsistencies in last %i blocks (%i transactions)\n", chainActive.Height() - pindexState->nHeight, nGoodTransactions);
@@ -5540,6 +5658,16 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         fDataIndex = gArgs.GetBoolArg("-dataindex", DEFAULT_DATAINDEX);
         pblocktree->WriteFlag("dataindex", fDataIndex);
         LogPrintf("%s: data index %s\n", __func__, fDataIndex ? "enabled" : "disabled");
+
+        // Use the provided setting for -sigmaindex in the new database
+        fSigmaIndex = gArgs.GetBoolArg("-sigmaindex", DEFAULT_SIGMAINDEX);
+        pblocktree->WriteFlag("sigmaindex", fSigmaIndex);
+        LogPrintf("%s: sigma mint index %s\n", __func__, fSigmaIndex ? "enabled" : "disabled");
+
+        // Use the provided setting for -privacystatsindex in the new database
+        fPrivacyStatsIndex = gArgs.GetBoolArg("-privacystatsindex", DEFAULT_PRIVACYSTATSINDEX);
+        pblocktree->WriteFlag("privacystatsindex", fPrivacyStatsIndex);
+        LogPrintf("%s: privacy statistics index %s\n", __func__, fPrivacyStatsIndex ? "enabled" : "disabled");
     }
 
     fDisableZerocoinTransactions = gArgs.GetBoolArg("-disablezerocointransactions", true);
@@ -6039,6 +6167,99 @@ bool DumpMempool(void)
     return true;
 }
 
+// The state is followed by a hash of everything before it
+static const uint64_t PRIVACY_STATE_DUMP_VERSION = 2;
+
+bool DumpPrivacyState(const uint256& hashBestBlock)
+{
+    int64_t start = GetTimeMicros();
+
+    try {
+        FILE* filestr = fsbridge::fopen(GetDataDir() / "privacystate.dat.new", "wb");
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        uint64_t version = PRIVACY_STATE_DUMP_VERSION;
+        ss << version;
+        ss << hashBestBlock;
+
+        CZerocoinState::GetZerocoinState()->WriteSnapshot(ss);
+        CSigmaState::GetSigmaState()->WriteSnapshot(ss);
+
+        file.write(ss.data(), ss.size());
+        file << Hash(ss.begin(), ss.end());
+
+        FileCommit(file.Get());
+        file.fclose();
+        RenameOver(GetDataDir() / "privacystate.dat.new", GetDataDir() / "privacystate.dat");
+        LogPrint(BCLog::BENCH, "Dumped zerocoin and sigma state: %gs\n", (GetTimeMicros()-start)*MICRO);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump zerocoin and sigma state: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
+bool LoadPrivacyState(CChain& chain)
+{
+    int64_t start = GetTimeMicros();
+
+    fs::path path = GetDataDir() / "privacystate.dat";
+    FILE* filestr = fsbridge::fopen(path, "rb");
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull() || chain.Tip() == nullptr) {
+        return false;
+    }
+
+    CZerocoinState *zerocoinState = CZerocoinState::GetZerocoinState();
+    CSigmaState *sigmaState = CSigmaState::GetSigmaState();
+    try {
+        // Check the whole file against its hash before trusting any of it
+        uint64_t nFileSize = fs::file_size(path);
+        if (nFileSize < sizeof(uint256)) {
+            LogPrintf("Zerocoin and sigma state on disk is truncated, rebuilding it\n");
+            return false;
+        }
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss.resize(nFileSize - sizeof(uint256));
+        file.read(ss.data(), ss.size());
+        uint256 hashFile;
+        file >> hashFile;
+        if (hashFile != Hash(ss.begin(), ss.end())) {
+            LogPrintf("Zerocoin and sigma state on disk is corrupted, rebuilding it\n");
+            return false;
+        }
+
+        uint64_t version;
+        uint256 hashBestBlock;
+        ss >> version;
+        ss >> hashBestBlock;
+        if (version != PRIVACY_STATE_DUMP_VERSION || hashBestBlock != chain.Tip()->GetBlockHash()) {
+            LogPrintf("Zerocoin and sigma state on disk does not match the chain tip, rebuilding it\n");
+            return false;
+        }
+
+        if (!zerocoinState->ReadSnapshot(ss, &chain) || !sigmaState->ReadSnapshot(ss, &chain) || !ss.empty()) {
+            LogPrintf("Zerocoin and sigma state on disk is inconsistent, rebuilding it\n");
+            zerocoinState->Reset();
+            sigmaState->Reset();
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize zerocoin and sigma state on disk: %s. Rebuilding it.\n", e.what());
+        zerocoinState->Reset();
+        sigmaState->Reset();
+        return false;
+    }
+
+    LogPrintf("Loaded zerocoin and sigma state at %s: %gs\n", chain.Tip()->GetBlockHash().ToString(), (GetTimeMicros()-start)*MICRO);
+    return true;
+}
+
 //! Guess how far we are in the verification process at the given block index
 double GuessVerificationProgress(const ChainTxData& data, const CBlockIndex *pindex) {
     if (pindex == nullptr)
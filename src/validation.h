@@ -157,6 +157,10 @@ static const bool DEFAULT_TIMESTAMPINDEX = false;
 static const bool DEFAULT_ADDRESSINDEX = false;
 static const bool DEFAULT_SPENTINDEX = false;
 static const bool DEFAULT_DATAINDEX = false;
+static const bool DEFAULT_SIGMAINDEX = false;
+static const bool DEFAULT_PRIVACYSTATSINDEX = false;
+/** Default for -zcverifyparallel */
+static const bool DEFAULT_ZEROCOIN_VERIFY_PARALLEL = false;
 
 struct BlockHasher
 {
@@ -218,6 +222,10 @@ extern bool fTxIndex;
 extern bool fAddressIndex;
 extern bool fSpentIndex;
 extern bool fTimestampIndex;
+extern bool fSigmaIndex;
+extern bool fPrivacyStatsIndex;
+/** Verify the zerocoin spends of a block concurrently */
+extern bool fZerocoinVerifyParallel;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
@@ -328,6 +336,8 @@ bool LoadChainTip(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run script checks on up to nHelpers threads of the compute executor */
+void InitScriptCheckQueue(int nHelpers);
 /** Return the average number of blocks that other nodes claim to have */
 int GetNumBlocksOfPeers();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
@@ -557,4 +567,10 @@ bool DumpMempool();
 /** Load the mempool from disk. */
 bool LoadMempool();
 
+/** Dump the zerocoin and sigma state to disk, tied to the given best block. */
+bool DumpPrivacyState(const uint256& hashBestBlock);
+
+/** Load the zerocoin and sigma state from disk, if it was dumped at the tip of the chain. */
+bool LoadPrivacyState(CChain& chain);
+
 #endif // BITCOIN_VALIDATION_H
@@ -200,9 +200,15 @@ void CGhostWallet::SyncWithChain(bool fGenerateMintPool)
                 LogPrintf("%s : Found wallet coin mint=%s count=%d tx=%s\n", __func__, pMint.first.GetHex(), pMint.second, txHash.GetHex());
                 found = true;
 
+                // with -sigmaindex the block of the mint is known, no need to search for it
+                CBlockIndex *pindexMint = nullptr;
+                CSigmaMintIndexValue mintIndexValue;
+                if (SigmaGetMintIndexValue(pMint.first, mintIndexValue))
+                    pindexMint = chainActive[mintIndexValue.blockHeight];
+
                 uint256 hashBlock;
                 CTransactionRef tx;
-                if (!GetTransaction(txHash, tx, Params().GetConsensus(), hashBlock, true)) {
+                if (!GetTransaction(txHash, tx, Params().GetConsensus(), hashBlock, true, pindexMint)) {
                     LogPrintf("%s : failed to get transaction for mint %s!\n", __func__, pMint.first.GetHex());
                     found = false;
                     nLastCountUsed = std::max(pMint.second, nLastCountUsed);
@@ -10,6 +10,7 @@
 #include <core_io.h>
 #include <httpserver.h>
 #include <validation.h>
+#include <txdb.h>
 #include <net.h>
 #include <policy/feerate.h>
 #include <policy/fees.h>
@@ -4813,6 +4814,59 @@ UniValue manageaddressbook(const JSONRPCRequest &request)
 /*********************/
 /* Staking Protocol */
 
+struct CPublicSupplyStats
+{
+    int nHeight;
+    uint64_t nPublicOutputs;
+    CAmount nPublicAmount;
+    uint64_t nZerocoinMintOutputs;
+    CAmount nZerocoinMintAmount;
+    uint64_t nSigmaMintOutputs;
+    CAmount nSigmaMintAmount;
+
+    CPublicSupplyStats() : nHeight(0), nPublicOutputs(0), nPublicAmount(0), nZerocoinMintOutputs(0),
+        nZerocoinMintAmount(0), nSigmaMintOutputs(0), nSigmaMintAmount(0) {}
+};
+
+//! Sum the unspent outputs of the coins database, keeping mints apart from
+//! the public supply. The cursor reads a database snapshot, so cs_main is only
+//! taken to resolve the height of its best block.
+static bool GetPublicSupplyStats(CCoinsView *view, CPublicSupplyStats &stats)
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    uint256 hashBlock = pcursor->GetBestBlock();
+    {
+        LOCK(cs_main);
+        BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
+        if (mi == mapBlockIndex.end())
+            return error("%s: unknown best block %s", __func__, hashBlock.ToString());
+        stats.nHeight = mi->second->nHeight;
+    }
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        Coin coin;
+        if (!pcursor->GetValue(coin))
+            return error("%s: unable to read value", __func__);
+
+        const CTxOut &out = coin.out;
+        if (out.scriptPubKey.IsZerocoinMint()) {
+            stats.nZerocoinMintOutputs++;
+            stats.nZerocoinMintAmount += out.nValue;
+        } else if (out.scriptPubKey.IsSigmaMint()) {
+            stats.nSigmaMintOutputs++;
+            stats.nSigmaMintAmount += out.nValue;
+        } else {
+            stats.nPublicOutputs++;
+            stats.nPublicAmount += out.nValue;
+        }
+        pcursor->Next();
+    }
+    return true;
+}
+
 UniValue getstakinginfo(const JSONRPCRequest &request)
 {
     CWallet *pwallet = GetWalletForJSONRPCRequest(request);
@@ -4821,8 +4875,10 @@ UniValue getstakinginfo(const JSONRPCRequest &request)
 
     if (request.fHelp || request.params.size() > 1)
         throw std::runtime_error(
-            "getstakinginfo\n"
+            "getstakinginfo ( supply )\n"
             "Returns an object containing staking-related information."
+            "\nArguments:\n"
+            "1. supply       (any, optional) If given, also report supply statistics read from the UTXO set\n"
             "\nResult:\n"
             "{\n"
             "  \"enabled\": true|false,         (boolean) if staking is enabled or not on this wallet\n"
@@ -4841,6 +4897,13 @@ UniValue getstakinginfo(const JSONRPCRequest &request)
             "  \"weight\": xxxxxxx              (numeric) the current stake weight of this wallet\n"
             "  \"netstakeweight\": xxxxxxx      (numeric) the current stake weight of the network\n"
             "  \"expectedtime\": xxxxxxx        (numeric) estimated time for next stake\n"
+            "  \"totalpublicsupply\": xxxxxxx   (numeric) unspent value outside of zerocoin and sigma mints, if supply was requested\n"
+            "  \"outputs\": n                   (numeric) number of unspent outputs making up totalpublicsupply\n"
+            "  \"zerocoinmintsupply\": xxxxxxx  (numeric) unspent value in zerocoin mint outputs\n"
+            "  \"zerocoinmintoutputs\": n       (numeric) number of unspent zerocoin mint outputs\n"
+            "  \"sigmamintsupply\": xxxxxxx     (numeric) unspent value in sigma mint outputs\n"
+            "  \"sigmamintoutputs\": n          (numeric) number of unspent sigma mint outputs\n"
+            "  \"supplyheight\": n              (numeric) the block height the supply statistics were taken at\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getstakinginfo", "")
@@ -4919,35 +4982,19 @@ UniValue getstakinginfo(const JSONRPCRequest &request)
 
     obj.pushKV("expectedtime", nExpectedTime);
 
-    LOCK(cs_main);
+    if (request.params.size() == 1) {
+        CPublicSupplyStats stats;
+        FlushStateToDisk();
+        if (!GetPublicSupplyStats(pcoinsdbview.get(), stats))
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read UTXO set");
 
-    if(request.params.size() == 1){
-        CAmount totalSupply = 0;
-        int amountofOuts = 0;
-
-        // manually verify all output amounts
-        for(auto it = 0; it < chainActive.Height(); it++){
-            CBlock block;
-            CBlockIndex *pindex = chainActive[it];
-            if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())){
-                for(auto ctx: block.vtx){
-                    for(int ss = 0; ss < ctx->vout.size(); ss++){
-                        if(ctx->vout[ss].scriptPubKey.IsZerocoinMint())
-                            continue;
-                        COutPoint out(ctx->GetHash(), ss);
-                        if(pcoinsTip->HaveCoin(out)){
-                            amountofOuts++;
-                            totalSupply += ctx->vout[ss].nValue;
-                        }
-                    }
-                }
-            }
-            else
-                return "ReadBlockFromDisk failed!";
-        }
-
-        obj.pushKV("totalpublicsupply", ValueFromAmount(totalSupply));
-        obj.pushKV("outputs", amountofOuts);
+        obj.pushKV("totalpublicsupply", ValueFromAmount(stats.nPublicAmount));
+        obj.pushKV("outputs", stats.nPublicOutputs);
+        obj.pushKV("zerocoinmintsupply", ValueFromAmount(stats.nZerocoinMintAmount));
+        obj.pushKV("zerocoinmintoutputs", stats.nZerocoinMintOutputs);
+        obj.pushKV("sigmamintsupply", ValueFromAmount(stats.nSigmaMintAmount));
+        obj.pushKV("sigmamintoutputs", stats.nSigmaMintOutputs);
+        obj.pushKV("supplyheight", stats.nHeight);
     }
 
     return obj;
@@ -5396,7 +5443,8 @@ UniValue listallserials(const JSONRPCRequest& request)
     UniValue results(UniValue::VARR);
     if(request.params.size() > 0){
         CBlockIndex *temp = chainActive[request.params[0].get_int()];
-        for(auto it = temp->spentSerials.begin(); it != temp->spentSerials.end(); it++){
+        const set<CBigNum> &spentSerials = temp->GetPrivacyData().spentSerials;
+        for(auto it = spentSerials.begin(); it != spentSerials.end(); it++){
             results.push_back(it->ToString());
         }
         return results;
@@ -5405,7 +5453,8 @@ UniValue listallserials(const JSONRPCRequest& request)
 
     for(auto it = 53000; it <= chainActive.Tip()->nHeight; it++){
         CBlockIndex *temp = chainActive[it];
-        for(auto it = temp->spentSerials.begin(); it != temp->spentSerials.end(); it++){
+        const set<CBigNum> &spentSerials = temp->GetPrivacyData().spentSerials;
+        for(auto it = spentSerials.begin(); it != spentSerials.end(); it++){
             results.push_back(it->ToString());
         }
     }
@@ -5517,6 +5566,21 @@ UniValue decryptallzerocoins(const JSONRPCRequest& request)
     return results;
 }
 
+// Privacy statistics of the active chain blocks from nFirst to nLast, read from -privacystatsindex
+static bool GetPrivacyStats(int nFirst, int nLast, CPrivacyStatsIndexValue &stats)
+{
+    stats.SetNull();
+    if (nLast >= 1 && !pblocktree->ReadPrivacyStatsIndex(nLast, stats))
+        return false;
+
+    CPrivacyStatsIndexValue before;
+    if (nFirst > 1 && !pblocktree->ReadPrivacyStatsIndex(nFirst - 1, before))
+        return false;
+
+    stats -= before;
+    return true;
+}
+
 UniValue getstakingaverage(const JSONRPCRequest& request)
 {
 
@@ -5535,6 +5599,15 @@ UniValue getstakingaverage(const JSONRPCRequest& request)
     if(chainActive.Tip()->nHeight < sample)
         sample = chainActive.Tip()->nHeight;
     int startHeight = chainActive.Tip()->nHeight - sample;
+
+    if(fPrivacyStatsIndex){
+        CPrivacyStatsIndexValue stats;
+        if(!GetPrivacyStats(startHeight, chainActive.Tip()->nHeight - 1, stats))
+            return "Privacy statistics index read failed!";
+        entry.push_back(Pair("average_stake_amount", (stats.stakeValue/sample)/COIN));
+        return entry;
+    }
+
     for(auto it = startHeight; it < chainActive.Tip()->nHeight; it++){
         CBlock block;
         CBlockIndex *pindex = chainActive[it];
@@ -5577,8 +5650,14 @@ UniValue ghostfeepayouttotal(const JSONRPCRequest& request)
 
     //Assume chainactive+1 is current block check height
     int startHeight = chainActive.Height() + 1 - totalCount;
+    if(fPrivacyStatsIndex){
+        CPrivacyStatsIndexValue stats;
+        if(!GetPrivacyStats(startHeight, chainActive.Height(), stats))
+            return "Privacy statistics index read failed!";
+        mintVector.push_back(stats.ghostedValue);
+    }
     //Grab fee from other blocks
-    for(auto it = startHeight; it < chainActive.Height() + 1; it++){
+    else for(auto it = startHeight; it < chainActive.Height() + 1; it++){
         CBlock block;
         CBlockIndex *pindex = chainActive[it];
         // Now get fees from past 719 blocks
@@ -5604,9 +5683,7 @@ UniValue ghostfeepayouttotal(const JSONRPCRequest& request)
                     }
                     // add input denoms
                     for(int k = 0; k < ctx->vin.size(); k++){
-                        std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                        newSpend = ParseSigmaSpend(ctx->vin[k]);
-                        inVal += newSpend.first->getIntDenomination();
+                        inVal += ParseSigmaSpendHeader(ctx->vin[k]).getIntDenomination();
                     }
                     CAmount neededForFee = (inVal - outVal)/0.0025;
                     mintVector.push_back(neededForFee);
@@ -5657,8 +5734,15 @@ UniValue ghostprivacysets(const JSONRPCRequest& request)
 
     //Ghostprotocol active since 53k
     int startHeight = 53000;
+    if(fPrivacyStatsIndex){
+        CPrivacyStatsIndexValue stats;
+        if(!GetPrivacyStats(startHeight, chainActive.Height(), stats))
+            return "Privacy statistics index read failed!";
+        for(int i = 0; i < PRIVACY_STATS_ZEROCOIN_DENOMS; i++)
+            mintVector[i] = stats.zerocoinMints[i] - stats.zerocoinSpends[i];
+    }
     //Grab fee from other blocks
-    for(auto it = startHeight; it < chainActive.Height() + 1; it++){
+    else for(auto it = startHeight; it < chainActive.Height() + 1; it++){
         CBlock block;
         CBlockIndex *pindex = chainActive[it];
         // Now get fees from past 719 blocks
@@ -5751,8 +5835,15 @@ UniValue ghostprivacysetsv2(const JSONRPCRequest& request)
 
     //Ghostprotocol active since 53k
     int startHeight = Params().GetConsensus().nSigmaStartBlock;
+    if(fPrivacyStatsIndex){
+        CPrivacyStatsIndexValue stats;
+        if(!GetPrivacyStats(startHeight, chainActive.Height(), stats))
+            return "Privacy statistics index read failed!";
+        for(int i = 0; i < PRIVACY_STATS_SIGMA_DENOMS; i++)
+            mintVector[i] = stats.sigmaMints[i] - stats.sigmaSpends[i];
+    }
     //Grab fee from other blocks
-    for(auto it = startHeight; it < chainActive.Height() + 1; it++){
+    else for(auto it = startHeight; it < chainActive.Height() + 1; it++){
         CBlock block;
         CBlockIndex *pindex = chainActive[it];
         if (ReadBlockFromDisk(block, pindex, Params().GetConsensus())){
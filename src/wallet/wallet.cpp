@@ -11,6 +11,7 @@
 #include <wallet/coincontrol.h>
 #include <consensus/consensus.h>
 #include <consensus/validation.h>
+#include <executor.h>
 #include <fs.h>
 #include <wallet/init.h>
 #include <key.h>
@@ -63,6 +64,8 @@ bool fWalletRbf = DEFAULT_WALLET_RBF;
 const char * DEFAULT_WALLET_DAT = "wallet.dat";
 const uint32_t BIP32_HARDENED_KEY_LIMIT = 0x80000000;
 const int ZEROCOIN_CONFIRM_HEIGHT = 0;
+// Block height of a stakeable output that still has to be looked up
+static const int STAKEABLE_HEIGHT_UNKNOWN = -2;
 
 OutputType g_address_type = OUTPUT_TYPE_DEFAULT;
 OutputType g_change_type = OUTPUT_TYPE_DEFAULT;
@@ -1026,6 +1029,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
         wtx.nTimeSmart = ComputeTimeSmart(wtx);
         AddToSpends(hash);
+        AddStakeableOutputs(wtx);
     }
 
     bool fUpdated = false;
@@ -1071,6 +1075,9 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
         }
     }
 
+    if (fUpdated)
+        SetStakeableHeight(hash, wtx.hashUnset() ? -1 : STAKEABLE_HEIGHT_UNKNOWN);
+
     //// debug print
     // LogPrintf("AddToWallet %s  %s%s\n", wtxIn.GetHash().ToString(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
 
@@ -1104,6 +1111,7 @@ bool CWallet::LoadToWallet(const CWalletTx& wtxIn)
     wtx.BindWallet(this);
     wtxOrdered.insert(std::make_pair(wtx.nOrderPos, TxPair(&wtx, nullptr)));
     AddToSpends(hash);
+    AddStakeableOutputs(wtx);
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
         if (it != mapWallet.end()) {
@@ -1472,6 +1480,9 @@ void CWallet::SyncTransaction(const CTransactionRef& ptx, const CBlockIndex *pin
     if (!AddToWalletIfInvolvingMe(ptx, pindex, posInBlock, true))
         return; // Not one of ours
 
+    if (pindex)
+        SetStakeableHeight(tx.GetHash(), pindex->nHeight);
+
     // If a transaction changes 'conflicted' state, that changes the balance
     // available of the outputs it spends. So force those to be
     // recomputed, also:
@@ -1521,6 +1532,7 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
     }
 
     m_last_block_processed = pindex;
+    nStakeableTipHeight = pindex->nHeight;
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
@@ -1528,7 +1540,12 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
 
     for (const CTransactionRef& ptx : pblock->vtx) {
         SyncTransaction(ptx);
+        SetStakeableHeight(ptx->GetHash(), -1);
     }
+
+    BlockMap::iterator mi = mapBlockIndex.find(pblock->hashPrevBlock);
+    if (mi != mapBlockIndex.end())
+        nStakeableTipHeight = mi->second->nHeight;
 }
 
 
@@ -3992,8 +4009,12 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
 {
     AssertLockHeld(cs_wallet); // mapWallet
     DBErrors nZapSelectTxRet = CWalletDB(*dbw,"cr+").ZapSelectTx(vHashIn, vHashOut);
-    for (uint256 hash : vHashOut)
+    for (uint256 hash : vHashOut) {
+        auto it = mapStakeableOutputs.lower_bound(COutPoint(hash, 0));
+        while (it != mapStakeableOutputs.end() && it->first.hash == hash)
+            it = mapStakeableOutputs.erase(it);
         mapWallet.erase(hash);
+    }
 
     if (nZapSelectTxRet == DB_NEED_REWRITE)
     {
@@ -8216,6 +8237,182 @@ bool CWallet::SetReserveBalance(CAmount nNewReserveBalance)
     return true;
 }
 
+void CWallet::AddStakeableOutputs(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    const uint256 &hash = wtx.GetHash();
+    for (size_t i = 0; i < wtx.tx->vout.size(); ++i)
+    {
+        const CScript &scriptPubKey = wtx.tx->vout[i].scriptPubKey;
+
+        CStakeableOutput output;
+        WitnessV0KeyHash wit_script_dest;
+        //Returns false if not coldstake
+        if (!ExtractStakingKeyID(scriptPubKey, output.scriptID, wit_script_dest))
+            continue;
+
+        output.tx = &wtx;
+        output.nValue = wtx.tx->vout[i].nValue;
+        output.nHeight = wtx.hashUnset() ? -1 : STAKEABLE_HEIGHT_UNKNOWN;
+
+        if (scriptPubKey.IsPayToScriptHash_CS() || scriptPubKey.IsPayToWitnessKeyHash_CS())
+        {
+            output.fLease = true;
+            output.fWitnessLease = scriptPubKey.IsPayToWitnessKeyHash_CS();
+            output.fHasFee = GetCoinstakeScriptFee(scriptPubKey, output.nFee);
+
+            CScript scriptOut;
+            if (GetCoinstakeScriptFeeRewardAddress(scriptPubKey, scriptOut))
+            {
+                output.fHasRewardScript = true;
+                ExtractStakingKeyID(scriptOut, output.rewardScriptID, output.rewardWitnessID);
+            }
+        }
+
+        mapStakeableOutputs[COutPoint(hash, i)] = output;
+    }
+
+    if (!wtx.hashUnset())
+        fStakeableHeightsDirty = true;
+}
+
+void CWallet::SetStakeableHeight(const uint256& hashTx, int nHeight)
+{
+    AssertLockHeld(cs_wallet);
+
+    auto it = mapStakeableOutputs.lower_bound(COutPoint(hashTx, 0));
+    for (; it != mapStakeableOutputs.end() && it->first.hash == hashTx; ++it)
+        it->second.nHeight = nHeight;
+
+    if (nHeight == STAKEABLE_HEIGHT_UNKNOWN)
+        fStakeableHeightsDirty = true;
+}
+
+void CWallet::ResolveStakeableHeights() const
+{
+    if (!fStakeableHeightsDirty)
+        return;
+
+    LOCK2(cs_main, cs_wallet);
+    fStakeableHeightsDirty = false;
+
+    if (nStakeableTipHeight < 0)
+        nStakeableTipHeight = chainActive.Height();
+
+    for (auto &entry : mapStakeableOutputs)
+    {
+        CStakeableOutput &output = entry.second;
+        if (output.nHeight != STAKEABLE_HEIGHT_UNKNOWN)
+            continue;
+
+        output.nHeight = -1;
+        const CWalletTx &wtx = *output.tx;
+        if (wtx.hashUnset() || wtx.nIndex == -1) // unconfirmed or conflicted
+            continue;
+
+        BlockMap::iterator mi = mapBlockIndex.find(wtx.hashBlock);
+        if (mi != mapBlockIndex.end() && chainActive.Contains(mi->second))
+            output.nHeight = mi->second->nHeight;
+    }
+}
+
+bool CWallet::IsStakeableOutputSpent(const COutPoint& outpoint) const
+{
+    AssertLockHeld(cs_wallet);
+
+    // Same as IsSpent, except that the depth of the spending transaction is
+    // judged from the wallet's own records so cs_main is not needed
+    std::pair<TxSpends::const_iterator, TxSpends::const_iterator> range;
+    range = mapTxSpends.equal_range(outpoint);
+
+    for (TxSpends::const_iterator it = range.first; it != range.second; ++it)
+    {
+        std::map<uint256, CWalletTx>::const_iterator mit = mapWallet.find(it->second);
+        if (mit == mapWallet.end())
+            continue;
+
+        const CWalletTx &wtx = mit->second;
+        bool fConflicted = !wtx.hashUnset() && wtx.nIndex == -1;
+        if (!wtx.isAbandoned() && !fConflicted)
+            return true; // Spent
+    }
+    return false;
+}
+
+/**
+ * Call func(outpoint, output, nDepth) for every stakeable output that is
+ * mature, unspent, not locked, allowed by the lease settings and owned by the
+ * wallet. Returns the depth of the deepest stakeable output.
+ */
+template <typename Callable>
+int CWallet::ForEachMatureStakeableOutput(int nTipHeight, Callable func) const
+{
+    AssertLockHeld(cs_wallet);
+
+    int coinbaseMaturity = nTipHeight >= Params().GetConsensus().nStartGhostFeeDistribution ? COINBASE_MATURITY_V2 : COINBASE_MATURITY;
+
+    bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET || Params().NetworkIDString() == CBaseChainParams::REGTEST);
+    if(fTestNet)
+        coinbaseMaturity = COINBASE_MATURITY_TESTNET;
+
+    int nRequiredDepth = coinbaseMaturity + 1;
+    int nDeepest = 0;
+
+    for (const auto &entry : mapStakeableOutputs)
+    {
+        const COutPoint &outpoint = entry.first;
+        const CStakeableOutput &output = entry.second;
+
+        int nDepth = output.nHeight >= 0 ? nTipHeight - output.nHeight + 1 : 0;
+
+        if (nDepth > nDeepest)
+            nDeepest = nDepth;
+
+        if (nDepth < nRequiredDepth)
+            continue;
+
+        if (IsStakeableOutputSpent(outpoint) || IsLockedCoin(outpoint.hash, outpoint.n))
+            continue;
+
+        if (output.fLease){
+            // Ignore witness LPOS contracts until clients are updated
+            if(output.fWitnessLease && ((nTipHeight + 1) < Params().GetConsensus().nStartWitnessLposContracts))
+                continue;
+            // Check if contract allows fee payouts
+            if(output.fHasFee){
+                if(output.nFee < nMinimumDelagatePercentage)
+                    continue;
+            }
+            //If script does not include fee and percentage is set, skip
+            else if(nMinimumDelagatePercentage > 0)
+                continue;
+
+            if(output.fHasRewardScript){
+                if(nDelegateRewardToMe){
+                    if(!HaveCScript(output.rewardScriptID))
+                        continue;
+                }
+                else if(!nDelegateRewardAddresses.empty()){
+                    std::string rewardStr = !output.rewardWitnessID.IsNull() ?
+                                EncodeDestination(output.rewardWitnessID, true) : EncodeDestination(output.rewardScriptID);
+                    if(std::find(nDelegateRewardAddresses.begin(), nDelegateRewardAddresses.end(), rewardStr) == nDelegateRewardAddresses.end())
+                        continue;
+                }
+            }
+            //If script does not include reward addres and fields are set, skip
+            else if(nDelegateRewardToMe || !nDelegateRewardAddresses.empty())
+                continue;
+        }
+
+        // for staking we do not support p2pkh
+        if (HaveCScript(output.scriptID))
+            func(outpoint, output, nDepth);
+    }
+
+    return nDeepest;
+}
+
 uint64_t CWallet::GetStakeWeight() const
 {
     // Choose coins to use
@@ -8224,11 +8421,7 @@ uint64_t CWallet::GetStakeWeight() const
     if (nBalance <= nReserveBalance)
         return 0;
 
-    int nHeight;
-    {
-        LOCK(cs_main);
-        nHeight = chainActive.Height()+1;
-    }
+    int nHeight = nStakeableTipHeight + 1;
 
     // Choose coins to use
     std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
@@ -8243,7 +8436,7 @@ uint64_t CWallet::GetStakeWeight() const
 
     uint64_t nWeight = 0;
 
-    LOCK2(cs_main, cs_wallet);
+    LOCK(cs_wallet);
     for (auto pcoin : setCoins)
     {
         nWeight += pcoin.first->tx->vout[pcoin.second].nValue;
@@ -8258,108 +8451,15 @@ void CWallet::AvailableCoinsForStaking(std::vector<COutput> &vCoins, int64_t nTi
 {
     vCoins.clear();
 
-    deepestTxnDepth = 0;
+    ResolveStakeableHeights();
 
     {
-        LOCK2(cs_main, cs_wallet);
-
-        int nHeight = chainActive.Tip()->nHeight;
-        int coinbaseMaturity = nHeight >= Params().GetConsensus().nStartGhostFeeDistribution ? COINBASE_MATURITY_V2 : COINBASE_MATURITY;
-
-        bool fTestNet = (Params().NetworkIDString() == CBaseChainParams::TESTNET || Params().NetworkIDString() == CBaseChainParams::REGTEST);
-        if(fTestNet)
-            coinbaseMaturity = COINBASE_MATURITY_TESTNET;
-
-        int nRequiredDepth = coinbaseMaturity + 1;
-
-        for (MapWallet_t::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-        {
-            const CWalletTx *pcoin = &it->second;
-            CTransactionRef tx = pcoin->tx;
-
-            int nDepth = pcoin->GetDepthInMainChainCached();
-
-            if (nDepth > deepestTxnDepth)
-                deepestTxnDepth = nDepth;
-
-            if (nDepth < nRequiredDepth)
-                continue;
-
-            const uint256 &wtxid = it->first;
-            for (size_t i = 0; i < tx->vout.size(); ++i)
-            {
-                const auto &txout = tx->vout[i];
-
-                if (IsSpent(wtxid, i)|| IsLockedCoin(wtxid, i))
-                    continue;
-
-                const CScript pscriptPubKey = txout.scriptPubKey;
-
-                if(pscriptPubKey.IsPayToScriptHash_CS() || pscriptPubKey.IsPayToWitnessKeyHash_CS()){
-                    // Ignore witness LPOS contracts until clients are updated
-                    if(pscriptPubKey.IsPayToWitnessKeyHash_CS() && ((nHeight + 1) < Params().GetConsensus().nStartWitnessLposContracts))
-                        continue;
-                    // Check if contract allows fee payouts
-                    int64_t feeOut = 0;
-                    if(GetCoinstakeScriptFee(pscriptPubKey, feeOut)){
-                        if(feeOut < nMinimumDelagatePercentage)
-                            continue;
-                    }
-                    //If script does not include fee and percentage is set, skip
-                    else if(nMinimumDelagatePercentage > 0)
-                        continue;
-
-                    CScript scriptOut;
-                    if(GetCoinstakeScriptFeeRewardAddress(pscriptPubKey, scriptOut)){
-                        if(nDelegateRewardToMe){
-                            CScriptID delegateRewardID;
-                            WitnessV0KeyHash wit_script_dest;
-                            ExtractStakingKeyID(scriptOut, delegateRewardID, wit_script_dest);
-
-                            if(!HaveCScript(delegateRewardID))
-                                continue;
-                        }
-                        else if(!nDelegateRewardAddresses.empty()){
-                            bool found = false;
-                            for(std::string addressString: nDelegateRewardAddresses){
-                                CScriptID delegateRewardID;
-                                WitnessV0KeyHash wit_script_dest;
-                                ExtractStakingKeyID(scriptOut, delegateRewardID, wit_script_dest);
-                                if(!wit_script_dest.IsNull()){
-                                    std::string rewardStr = EncodeDestination(wit_script_dest, true);
-                                    if(rewardStr == addressString)
-                                        found = true;
-                                }
-                                else{
-                                    std::string rewardStr = EncodeDestination(delegateRewardID);
-                                    if(rewardStr == addressString)
-                                        found = true;
-                                }
-                            }
-                            if(!found)
-                                continue;
-
-                        }
-
-                    }
-                    //If script does not include reward addres and fields are set, skip
-                    else if(nDelegateRewardToMe || !nDelegateRewardAddresses.empty())
-                        continue;
-                }
-
-                CScriptID script_dest;
-                WitnessV0KeyHash wit_script_dest;
-                //Returns false if not coldstake
-                if (!ExtractStakingKeyID(pscriptPubKey, script_dest, wit_script_dest))
-                    continue;
-
-                // for staking we do not support p2pkh
-                const CScriptID& destScriptID = script_dest;
-                if (HaveCScript(destScriptID))
-                    vCoins.push_back(COutput(pcoin, i, nDepth, true, true, true));
+        LOCK(cs_wallet);
 
-            }
-        }
+        deepestTxnDepth = ForEachMatureStakeableOutput(nStakeableTipHeight,
+            [&vCoins](const COutPoint &outpoint, const CStakeableOutput &output, int nDepth) {
+                vCoins.push_back(COutput(output.tx, outpoint.n, nDepth, true, true, true));
+            });
     }
 
     //Sort staking list by (amount/height) instead of randomness
@@ -8433,19 +8533,28 @@ bool CWallet::CreateCoinStake(unsigned int nBits, int64_t nTime, int nBlockHeigh
     CAmount nCredit = 0;
     CScript scriptPubKeyKernel;
 
+    // Test the kernels of all selected coins up front, the cache keeps the
+    // per coin part of the kernel hash for as long as the tip does not change
+    std::vector<COutPoint> vPrevouts;
+    vPrevouts.reserve(setCoins.size());
+    for (const auto &pcoin : setCoins)
+        vPrevouts.push_back(COutPoint(pcoin.first->GetHash(), pcoin.second));
+
+    std::vector<bool> vKernelFound;
+    stakeKernelCache.Update(pindexPrev, nBits, vPrevouts);
+    stakeKernelCache.Search(nTime, vKernelFound);
+
     std::set<std::pair<const CWalletTx*,unsigned int> >::iterator it = setCoins.begin();
 
-    for (; it != setCoins.end(); ++it)
+    for (size_t nCoin = 0; it != setCoins.end(); ++it, ++nCoin)
     {
         auto pcoin = *it;
         if (ThreadStakeMinerStopped()) // interruption_point
             return false;
 
-        COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
-
-        int64_t nBlockTime;
+        COutPoint prevoutStake = vPrevouts[nCoin];
 
-        if (CheckKernel(pindexPrev, nBits, nTime, prevoutStake, &nBlockTime))
+        if (vKernelFound[nCoin])
         {
             LOCK(cs_wallet);
             // Found a kernel
@@ -8725,24 +8834,14 @@ bool CWallet::CreateCoinStake(unsigned int nBits, int64_t nTime, int nBlockHeigh
 
         //pay or dont pay the fees to all nodes
         if(payFees && returnFee != 0){
-            vector<CGhostnode> ghostnodeVector = mnodeman.GetFullGhostnodeVector();
-
-            int totalActiveNodes = 0;
             int startBlock = (chainActive.Height() + 1) - (Params().GetConsensus().nGhostFeeDistributionCycle - 1);
             int64_t ensureNodeActiveBefore = chainActive[startBlock]->GetBlockTime();
 
-            for(auto node: ghostnodeVector){
-
-                if(node.IsEnabled() && (node.sigTime <= ensureNodeActiveBefore))
-                    totalActiveNodes++;
-            }
-
-            CAmount feePayout = returnFee/totalActiveNodes;
+            CGhostFeePayeesRef payees = mnodeman.GetGhostFeePayees(chainActive.Tip()->GetBlockHash(), ensureNodeActiveBefore);
+            if(!payees->IsEmpty()){
+                CAmount feePayout = returnFee/payees->GetCount();
 
-            for(auto node: ghostnodeVector){
-                if(node.IsEnabled() && (node.sigTime <= ensureNodeActiveBefore)){
-                    CScript mnpayee;
-                    mnpayee = GetScriptForDestination(node.pubKeyCollateralAddress.GetID());
+                for(const CScript& mnpayee: payees->vPayees){
                     txNew.vout.push_back(CTxOut(feePayout,mnpayee));
                 }
             }
@@ -8841,9 +8940,7 @@ bool CWallet::SignBlock(CBlockTemplate *pblocktemplate, int nHeight, int64_t nSe
                 }
                 // add input denoms
                 for(int k = 0; k < pblock->vtx[i]->vin.size(); k++){
-                    std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> newSpend;
-                    newSpend = ParseSigmaSpend(pblock->vtx[i]->vin[k]);
-                    inVal += newSpend.first->getIntDenomination();
+                    inVal += ParseSigmaSpendHeader(pblock->vtx[i]->vin[k]).getIntDenomination();
                 }
                 nGhostFees += inVal - outVal;
 
@@ -8936,15 +9033,14 @@ CAmount CWallet::GetStakeableBalance() const
 {
     CAmount nBalance = 0;
 
-    LOCK2(cs_main, cs_wallet);
+    ResolveStakeableHeights();
 
-    for (MapWallet_t::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-    {
-        const CWalletTx* pcoin = &(*it).second;
-        if (!pcoin->IsTrusted())
-            continue;
-        nBalance += pcoin->GetAvailableCredit(true, true);
-    };
+    LOCK(cs_wallet);
+
+    ForEachMatureStakeableOutput(nStakeableTipHeight,
+        [&nBalance](const COutPoint &outpoint, const CStakeableOutput &output, int nDepth) {
+            nBalance += output.nValue;
+        });
 
     return nBalance;
 }
@@ -9673,58 +9769,65 @@ bool CWallet::CreateSigmaSpendTransaction(std::string &toKey, vector <CScript> p
         serializedId.push_back(coinId);
     }
 
-    for(int i = 0; i < nValueBatch.size(); i++){
-        {
-            LOCK2(cs_main, cs_wallet);
-            {
+    // The proofs of the inputs are independent of each other, generate them on the compute executor
+    std::vector<std::unique_ptr<sigma::CoinSpend>> spendBatch(nValueBatch.size());
+    std::vector<std::string> spendFailReason(nValueBatch.size());
+    GetComputeExecutor().ParallelFor(nValueBatch.size(), [&](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd; i++) {
+            // We use incomplete transaction hash as metadata.
+            sigma::SpendMetaData metaData(serializedId[i], txHashBatch[i], txNewTemp.GetHash());
 
-                // We use incomplete transaction hash as metadata.
-                sigma::SpendMetaData metaData(serializedId[i], txHashBatch[i], txNewTemp.GetHash());
+            // Construct the CoinSpend object. This acts like a signature on the
+            // transaction.
+            sigma::PrivateCoin privateCoin(sParams, denominationBatch[i]);
 
-                // Construct the CoinSpend object. This acts like a signature on the
-                // transaction.
-                sigma::PrivateCoin privateCoin(sParams, denominationBatch[i]);
+            int txVersion = sigma::SIGMA_VERSION_2;
 
-                int txVersion = sigma::SIGMA_VERSION_2;
+            LogPrintf("CreateSigmaSpendTransation: tx version=%d, tx metadata hash=%s\n", txVersion, txNew.GetHash().ToString());
 
-                LogPrintf("CreateSigmaSpendTransation: tx version=%d, tx metadata hash=%s\n", txVersion, txNew.GetHash().ToString());
+            // 2. Get pubcoin from the private coin
+            sigma::PublicCoin pubCoinSelected(coinToUseBatch[i].value, denominationBatch[i]);
 
-                // 2. Get pubcoin from the private coin
-                sigma::PublicCoin pubCoinSelected(coinToUseBatch[i].value, denominationBatch[i]);
+            // Now make sure the coin is valid.
+            if (!pubCoinSelected.validate()) {
+                spendFailReason[i] = _("the selected sigma mint is an invalid coin");
+                continue;
+            }
 
-                // Now make sure the coin is valid.
-                if (!pubCoinSelected.validate()) {
-                    strFailReason = _("the selected sigma mint is an invalid coin");
-                    return false;
-                }
+            privateCoin.setVersion(txVersion);
+            privateCoin.setPublicCoin(pubCoinSelected);
+            privateCoin.setRandomness(coinToUseBatch[i].randomness);
+            privateCoin.setSerialNumber(coinToUseBatch[i].serialNumber);
+            privateCoin.setEcdsaSeckey(coinToUseBatch[i].ecdsaSecretKey);
 
-                privateCoin.setVersion(txVersion);
-                privateCoin.setPublicCoin(pubCoinSelected);
-                privateCoin.setRandomness(coinToUseBatch[i].randomness);
-                privateCoin.setSerialNumber(coinToUseBatch[i].serialNumber);
-                privateCoin.setEcdsaSeckey(coinToUseBatch[i].ecdsaSecretKey);
+            std::unique_ptr<sigma::CoinSpend> spend(new sigma::CoinSpend(sParams, privateCoin, anonimity_set_batch[i], metaData, true));
+            spend->setVersion(txVersion);
 
-                sigma::CoinSpend spend(sParams, privateCoin, anonimity_set_batch[i], metaData, true);
-                spend.setVersion(txVersion);
+            // This is a sanity check. The CoinSpend object should always verify,
+            // but why not check before we put it onto the wire?
+            if (!spend->Verify(anonimity_set_batch[i], metaData, true)) {
+                spendFailReason[i] = _("the sigma spend coin transaction did not verify");
+                continue;
+            }
+            spendBatch[i] = std::move(spend);
+        }
+    });
 
-                // This is a sanity check. The CoinSpend object should always verify,
-                // but why not check before we put it onto the wire?
-                if (!spend.Verify(anonimity_set_batch[i], metaData, true)) {
-                    strFailReason = _("the sigma spend coin transaction did not verify");
-                    return false;
-                }
+    for(int i = 0; i < nValueBatch.size(); i++){
+        if (!spendBatch[i]) {
+            strFailReason = spendFailReason[i];
+            return false;
+        }
 
-                coinSerialBatch.push_back(spend.getCoinSerialNumber());
-                // Serialize the CoinSpend object into a buffer.
-                CDataStream serializedCoinSpend(SER_NETWORK, PROTOCOL_VERSION);
-                serializedCoinSpend << spend;
+        coinSerialBatch.push_back(spendBatch[i]->getCoinSerialNumber());
+        // Serialize the CoinSpend object into a buffer.
+        CDataStream serializedCoinSpend(SER_NETWORK, PROTOCOL_VERSION);
+        serializedCoinSpend << *spendBatch[i];
 
-                CScript tmp = CScript() << OP_SIGMASPEND; //<< serializedCoinSpend.size();
+        CScript tmp = CScript() << OP_SIGMASPEND; //<< serializedCoinSpend.size();
 
-                tmp.insert(tmp.end(), serializedCoinSpend.begin(), serializedCoinSpend.end());
-                txNew.vin[i].scriptSig.assign(tmp.begin(), tmp.end());
-            }
-        }
+        tmp.insert(tmp.end(), serializedCoinSpend.begin(), serializedCoinSpend.end());
+        txNew.vin[i].scriptSig.assign(tmp.begin(), tmp.end());
     }
 
     // Embed the constructed transaction data in wtxNew.
@@ -39,6 +39,7 @@
 #include <crypto/hmac_sha256.h>
 #include <crypto/hmac_sha512.h>
 #include <miner.h>
+#include <pos/kernel.h>
 #include <univalue/include/univalue.h>
 
 typedef CWallet* CWalletRef;
@@ -1089,6 +1090,31 @@ public:
     std::string ToString() const;
 };
 
+/** Wallet output with a script that can stake, classified once when the transaction is added */
+class CStakeableOutput
+{
+public:
+    const CWalletTx *tx;
+    CAmount nValue;
+    // Height of the block holding the transaction, -1 if unconfirmed
+    int nHeight;
+
+    // Script that must be in the wallet to stake the output
+    CScriptID scriptID;
+
+    // Lease (coldstake) contract terms
+    bool fLease;
+    bool fWitnessLease;
+    bool fHasFee;
+    int64_t nFee;
+    bool fHasRewardScript;
+    CScriptID rewardScriptID;
+    WitnessV0KeyHash rewardWitnessID;
+
+    CStakeableOutput() : tx(nullptr), nValue(0), nHeight(-1), fLease(false), fWitnessLease(false),
+        fHasFee(false), nFee(0), fHasRewardScript(false) {}
+};
+
 
 
 
@@ -1250,6 +1276,24 @@ private:
     void AddToSpends(const COutPoint& outpoint, const uint256& wtxid);
     void AddToSpends(const uint256& wtxid);
 
+    /**
+     * Outputs of wallet transactions that can stake, kept up to date as
+     * transactions are added and blocks are connected or disconnected, so the
+     * stake miner does not have to scan mapWallet or take cs_main.
+     */
+    mutable std::map<COutPoint, CStakeableOutput> mapStakeableOutputs;
+    // Height of the last block the wallet processed, for the depth of stakeable outputs
+    mutable std::atomic<int> nStakeableTipHeight;
+    // Set when the block height of some stakeable output has to be looked up
+    mutable std::atomic<bool> fStakeableHeightsDirty;
+
+    void AddStakeableOutputs(const CWalletTx& wtx);
+    void SetStakeableHeight(const uint256& hashTx, int nHeight);
+    void ResolveStakeableHeights() const;
+    bool IsStakeableOutputSpent(const COutPoint& outpoint) const;
+    template <typename Callable>
+    int ForEachMatureStakeableOutput(int nTipHeight, Callable func) const;
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -1385,6 +1429,8 @@ public:
         fScanningWallet = false;
         walletVersion = 0;
         activeContracts.clear();
+        nStakeableTipHeight = -1;
+        fStakeableHeightsDirty = true;
     }
 
     void setGhostWallet(CGhostWallet* ghostWallet)
@@ -1704,6 +1750,7 @@ public:
     size_t nAutoGhosterThread = 9999999; // unset
 
     mutable int deepestTxnDepth = 0; // for stake mining
+    CStakeKernelCache stakeKernelCache; // for stake mining
 
     mutable int m_greatest_txn_depth = 0; // depth of most deep txn
     //mutable int m_least_txn_depth = 0; // depth of least deep txn
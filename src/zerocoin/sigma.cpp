@@ -4,6 +4,10 @@
 
 #include <zerocoin/sigma.h>
 #include <zerocoin/zerocoin.h>
+#include <cuckoocache.h>
+#include <executor.h>
+#include <script/sigcache.h>
+#include <txdb.h>
 #include <timedata.h>
 #include <util.h>
 #include <base58.h>
@@ -15,10 +19,74 @@
 #include <net_processing.h>
 #include <utilstrencodings.h>
 
+#include <boost/thread.hpp>
+
 sigma::Params* SParams = sigma::Params::get_default();
 
 static CSigmaState sigmaState;
 
+// CSigmaVerificationCache
+
+namespace {
+/**
+ * Sigma spends whose proofs have been verified successfully. A spend is verified when
+ * it enters the mempool and again when its block gets checked, sometimes more than
+ * once, and the proof of it is by far the most expensive part.
+ */
+class CSigmaVerificationCache
+{
+private:
+    //! Entries are Hash(nonce || spend script || metadata || anonymity set)
+    uint256 nonce;
+    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_sigmacache;
+
+public:
+    CSigmaVerificationCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void
+    ComputeEntry(uint256& entry, const CScript& scriptSig, const sigma::SpendMetaData& metaData,
+            sigma::CoinDenomination denomination, const CSigmaState::CAnonymitySet& anonymitySet, bool fPadding)
+    {
+        CHashWriter h(SER_GETHASH, 0);
+        h << nonce << scriptSig << metaData << (int)denomination
+          << anonymitySet.GetTipBlockHash() << (uint64_t)anonymitySet.size() << fPadding;
+        entry = h.GetHash();
+    }
+
+    bool
+    Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_sigmacache);
+        return setValid.contains(entry, false);
+    }
+
+    void Set(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_sigmacache);
+        setValid.insert(entry);
+    }
+    uint32_t setup_bytes(size_t n)
+    {
+        return setValid.setup_bytes(n);
+    }
+};
+
+static CSigmaVerificationCache sigmaVerificationCache;
+} // namespace
+
+void InitSigmaVerificationCache()
+{
+    size_t nMaxCacheSize = std::max((int64_t)0, gArgs.GetArg("-maxsigmacachesize", DEFAULT_MAX_SIGMA_CACHE_SIZE)) * ((size_t) 1 << 20);
+    size_t nElems = sigmaVerificationCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for sigma verification cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
 uint256 GetSerialHash(const Scalar& bnSerial)
 {
     CDataStream ss(SER_GETHASH, 0);
@@ -99,6 +167,51 @@ std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTx
     return std::make_pair(std::move(spend), groupId);
 }
 
+int64_t CSigmaSpendHeader::getIntDenomination() const
+{
+    int64_t denom_value;
+    DenominationToInteger(denomination, denom_value);
+    return denom_value;
+}
+
+CSigmaSpendHeader ParseSigmaSpendHeader(const CTxIn& in)
+{
+    CSigmaSpendHeader header;
+    header.groupId = in.prevout.n;
+
+    if (header.groupId < 1 || header.groupId >= INT_MAX || in.scriptSig.size() < 1) {
+        throw CBadTxIn();
+    }
+
+    CDataStream serialized(
+        (const char *)&*(in.scriptSig.begin() + 1),
+        (const char *)&*in.scriptSig.end(),
+        SER_NETWORK,
+        PROTOCOL_VERSION
+    );
+
+    // Skip the proof: B, the r1 proof's A, C, D, f, ZA and ZC, then Gk and z
+    static const int nPointSize = GroupElement().memoryRequired();
+    static const int nScalarSize = Scalar().memoryRequired();
+    serialized.ignore(4 * nPointSize);
+    serialized.ignore(ReadCompactSize(serialized) * nScalarSize);
+    serialized.ignore(2 * nScalarSize);
+    serialized.ignore(ReadCompactSize(serialized) * nPointSize);
+    serialized.ignore(nScalarSize);
+
+    unsigned int version;
+    int64_t denomination_value;
+    std::vector<unsigned char> ecdsaPubkey, ecdsaSignature;
+    serialized >> header.serial >> version >> denomination_value >> header.accumulatorBlockHash
+               >> ecdsaPubkey >> ecdsaSignature;
+
+    header.version = version;
+    header.denomination = sigma::CoinDenomination::SIGMA_1;
+    sigma::IntegerToDenomination(denomination_value, header.denomination);
+
+    return header;
+}
+
 bool CheckSigmaSpendTransaction(
         const CTransaction &tx,
         const vector<sigma::CoinDenomination>& targetDenominations,
@@ -113,10 +226,15 @@ bool CheckSigmaSpendTransaction(
     int vinIndex = -1;
     std::unordered_set<Scalar, sigma::CScalarHash> spendSerials;
 
+    // Spends of a block are verified all at once when the whole block has been checked,
+    // otherwise just the spends of this transaction are batched together
+    CSigmaSpendBatch txSpendBatch;
+    bool fBlockBatch = sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete && !isVerifyDB && !isCheckWallet;
+    CSigmaSpendBatch &spendBatch = fBlockBatch ? sigmaTxInfo->spendBatch : txSpendBatch;
+
     for (const CTxIn &txin : tx.vin)
     {
-        std::unique_ptr<sigma::CoinSpend> spend;
-        uint32_t pubcoinId;
+        CSigmaSpendHeader spend;
 
         vinIndex++;
         if (txin.scriptSig.IsSigmaSpend())
@@ -125,15 +243,16 @@ bool CheckSigmaSpendTransaction(
             hasNonSigmaInputs = true;
 
         try {
-            std::tie(spend, pubcoinId) = ParseSigmaSpend(txin);
+            spend = ParseSigmaSpendHeader(txin);
         } catch (CBadTxIn&) {
             return state.DoS(100,
                 false,
                 REJECT_MALFORMED,
                 "CheckSigmaSpendTransaction: invalid spend transaction");
         }
+        uint32_t pubcoinId = spend.groupId;
 
-        if (spend->getVersion() != sigma::SIGMA_VERSION_1 && spend->getVersion() != sigma::SIGMA_VERSION_2) {
+        if (spend.version != sigma::SIGMA_VERSION_1 && spend.version != sigma::SIGMA_VERSION_2) {
             return state.DoS(100,
                              false,
                              NSEQUENCE_INCORRECT,
@@ -151,42 +270,20 @@ bool CheckSigmaSpendTransaction(
         }
         txHashForMetadata = txTemp.GetHash();
 
-        CSigmaState::CoinGroupInfo coinGroup;
-        if (!sigmaState.GetCoinGroupInfo(targetDenominations[vinIndex], pubcoinId, coinGroup))
+        uint256 accumulatorBlockHash = spend.accumulatorBlockHash;
+
+        CSigmaState::CAnonymitySet anonymitySet;
+        if (!sigmaState.GetAnonymitySet(targetDenominations[vinIndex], pubcoinId, accumulatorBlockHash, anonymitySet))
             return state.DoS(100, false, NO_MINT_ZEROCOIN,
                     "CheckSigmaSpendTransaction: Error: no coins were minted with such parameters");
 
-        bool passVerify = false;
-        CBlockIndex *index = coinGroup.lastBlock;
-        pair<sigma::CoinDenomination, int> denominationAndId = std::make_pair(
-            targetDenominations[vinIndex], pubcoinId);
-
-        uint256 accumulatorBlockHash = spend->getAccumulatorBlockHash();
-
         // We use incomplete transaction hash as metadata.
         sigma::SpendMetaData newMetaData(
             pubcoinId,
             accumulatorBlockHash,
             txHashForMetadata);
 
-        // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
-        while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
-            index = index->pprev;
-
-        // Build a vector with all the public coins with given denomination and accumulator id before
-        // the block on which the spend occured.
-        // This list of public coins is required by function "Verify" of CoinSpend.
-        std::vector<sigma::PublicCoin> anonymity_set;
-        while(true) {
-            for(const sigma::PublicCoin& pubCoinValue: index->mintedPubCoinsV2[denominationAndId]) {
-                anonymity_set.push_back(pubCoinValue);
-            }
-            if (index == coinGroup.firstBlock)
-                break;
-            index = index->pprev;
-        }
-
-        bool fPadding = spend->getVersion() >= sigma::SIGMA_VERSION_2;
+        bool fPadding = spend.version >= sigma::SIGMA_VERSION_2;
         // require version 2 right away on full sync
         if (!isVerifyDB) {
             bool isSync = IsInitialBlockDownload();
@@ -197,36 +294,56 @@ bool CheckSigmaSpendTransaction(
             }
         }
 
-        passVerify = spend->Verify(anonymity_set, newMetaData, fPadding);
-        if (passVerify) {
-            Scalar serial = spend->getCoinSerialNumber();
-            // do not check for duplicates in case we've seen exact copy of this tx in this block before
-            if (!(sigmaTxInfo && sigmaTxInfo->sTransactions.count(hashTx) > 0)) {
-                if (!CheckSigmaSpendSerial(
-                            state, sigmaTxInfo, serial, nHeight, false))
-                    return false;
+        Scalar serial = spend.serial;
+        sigma::CoinDenomination denomination = spend.denomination;
+
+        // Proofs verified before, typically on mempool admission, are not verified again
+        uint256 cacheEntry;
+        sigmaVerificationCache.ComputeEntry(cacheEntry, txin.scriptSig, newMetaData,
+            targetDenominations[vinIndex], anonymitySet, fPadding);
+        if (!sigmaVerificationCache.Get(cacheEntry)) {
+            // The proof is only decoded when it has to be verified
+            std::unique_ptr<sigma::CoinSpend> proof = std::move(ParseSigmaSpend(txin).first);
+
+            CSigmaSpendBatch::GroupKey groupKey = std::make_tuple(
+                targetDenominations[vinIndex], pubcoinId, anonymitySet.size());
+            if (spendBatch.HasAnonymitySet(groupKey)) {
+                spendBatch.Add(groupKey, std::move(proof), newMetaData, fPadding, cacheEntry);
             }
-
-            if (!spendSerials.insert(serial).second) {
-                return state.DoS(100,
-                    error("CheckSpendSigmaTansaction: two or more spends with same serial in the same transaction"));
+            else {
+                // The list of public coins is required by function "Verify" of CoinSpend.
+                std::vector<sigma::PublicCoin> anonymity_set;
+                anonymity_set.reserve(anonymitySet.size());
+                anonymitySet.CopyTo(anonymity_set);
+                spendBatch.Add(groupKey, std::move(anonymity_set), std::move(proof), newMetaData, fPadding, cacheEntry);
             }
+        }
 
-            if(!isVerifyDB && !isCheckWallet) {
-                if (sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete) {
-                    // add spend information to the index
-                    sigmaTxInfo->spentSerials.insert(std::make_pair(
-                                serial, (int)spend->getDenomination()));
-                    sigmaTxInfo->sTransactions.insert(hashTx);
-                }
-            }
+        // do not check for duplicates in case we've seen exact copy of this tx in this block before
+        if (!(sigmaTxInfo && sigmaTxInfo->sTransactions.count(hashTx) > 0)) {
+            if (!CheckSigmaSpendSerial(
+                        state, sigmaTxInfo, serial, nHeight, false))
+                return false;
         }
-        else {
-            LogPrintf("CheckSigmaSpendTransaction: verification failed at block=%d, denomID=%d, pubcoinID=%d\n", nHeight, spend->getDenomination(), pubcoinId);
-            return false;
+
+        if (!spendSerials.insert(serial).second) {
+            return state.DoS(100,
+                error("CheckSpendSigmaTansaction: two or more spends with same serial in the same transaction"));
+        }
+
+        if(!isVerifyDB && !isCheckWallet) {
+            if (sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete) {
+                // add spend information to the index
+                sigmaTxInfo->spentSerials.insert(std::make_pair(
+                            serial, (int)denomination));
+                sigmaTxInfo->sTransactions.insert(hashTx);
+            }
         }
     }
 
+    if (!fBlockBatch && !spendBatch.Verify(nHeight))
+        return false;
+
     if(!isVerifyDB && !isCheckWallet) {
         if (sigmaTxInfo && !sigmaTxInfo->fInfoIsComplete) {
             sigmaTxInfo->sTransactions.insert(hashTx);
@@ -379,8 +496,36 @@ bool CheckSigmaTransaction(
     return true;
 }
 
-void DisconnectTipSigma(CBlock & /*block*/, CBlockIndex *pindexDelete) {
+// Collects the -sigmaindex entries of the mints of a block, null ones when the block is disconnected
+static void GetSigmaMintIndexEntries(const CBlock &block, int nHeight, bool fErase,
+        std::vector<std::pair<uint256, CSigmaMintIndexValue> > &entries) {
+    for (const CTransactionRef &tx : block.vtx) {
+        if (!tx->IsSigmaMint())
+            continue;
+        for (unsigned int i = 0; i < tx->vout.size(); i++) {
+            if (!tx->vout[i].scriptPubKey.IsSigmaMint())
+                continue;
+            try {
+                uint256 pubCoinValueHash = GetPubCoinValueHash(ParseSigmaMintScript(tx->vout[i].scriptPubKey));
+                entries.push_back(std::make_pair(pubCoinValueHash,
+                        fErase ? CSigmaMintIndexValue() : CSigmaMintIndexValue(tx->GetHash(), i, nHeight)));
+            } catch (std::invalid_argument&) {
+                // not a valid mint, it can't have been accepted in a block
+            }
+        }
+    }
+}
+
+bool DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete) {
     sigmaState.RemoveBlock(pindexDelete);
+
+    if (fSigmaIndex) {
+        std::vector<std::pair<uint256, CSigmaMintIndexValue> > entries;
+        GetSigmaMintIndexEntries(block, pindexDelete->nHeight, true, entries);
+        if (!entries.empty() && !pblocktree->UpdateSigmaMintIndex(entries))
+            return error("DisconnectTipSigma: failed to update sigma mint index");
+    }
+    return true;
 }
 
 Scalar SigmaGetSpendSerialNumber(const CTransaction &tx, const CTxIn &txin) {
@@ -388,16 +533,14 @@ Scalar SigmaGetSpendSerialNumber(const CTransaction &tx, const CTxIn &txin) {
         return Scalar(uint64_t(0));
 
     try {
-        CDataStream serializedCoinSpend(
-                (const char *)&*(txin.scriptSig.begin() + 1),
-                (const char *)&*txin.scriptSig.end(),
-                SER_NETWORK, PROTOCOL_VERSION);
-        sigma::CoinSpend spend(SParams, serializedCoinSpend);
-        return spend.getCoinSerialNumber();
+        return ParseSigmaSpendHeader(txin).serial;
     }
     catch (const std::ios_base::failure &) {
         return Scalar(uint64_t(0));
     }
+    catch (const CBadTxIn &) {
+        return Scalar(uint64_t(0));
+    }
 }
 
 CAmount GetSpendTransactionInput(const CTransaction &tx) {
@@ -407,18 +550,16 @@ CAmount GetSpendTransactionInput(const CTransaction &tx) {
     try {
         CAmount sum(0);
         for(const CTxIn& txin: tx.vin){
-            CDataStream serializedCoinSpend(
-                    (const char *)&*(txin.scriptSig.begin() + 1),
-                    (const char *)&*txin.scriptSig.end(),
-                    SER_NETWORK, PROTOCOL_VERSION);
-            sigma::CoinSpend spend(SParams, serializedCoinSpend);
-            sum += spend.getIntDenomination();
+            sum += ParseSigmaSpendHeader(txin).getIntDenomination();
         }
         return sum;
     }
     catch (const std::runtime_error &) {
         return CAmount(0);
     }
+    catch (const CBadTxIn &) {
+        return CAmount(0);
+    }
 }
 
 
@@ -435,8 +576,8 @@ bool ConnectBlockSigma(
     // Add sigma transaction information to index
     if (pblock && pblock->sigmaTxInfo) {
         
-        if (!fJustCheck)
-            pindexNew->spentSerialsV2.clear();
+        if (!fJustCheck && pindexNew->privacyData)
+            pindexNew->privacyData->spentSerialsV2.clear();
         
         for(auto& serial: pblock->sigmaTxInfo->spentSerials) {
             if (!CheckSigmaSpendSerial(state, pblock->sigmaTxInfo.get(), serial.first,
@@ -445,7 +586,7 @@ bool ConnectBlockSigma(
             }
             
             if (!fJustCheck) {
-                pindexNew->spentSerialsV2.insert(serial.first);
+                pindexNew->PrivacyData().spentSerialsV2.insert(serial.first);
                 sigmaState.AddSpend(serial.first);
             }
         }
@@ -462,12 +603,20 @@ bool ConnectBlockSigma(
             
             //LogPrintf("ConnectTipSigma: mint added denomination=%d, id=%d\n", denomination, mintId);
             pair<sigma::CoinDenomination, int> denomAndId = make_pair(denomination, mintId);
-            pindexNew->mintedPubCoinsV2[denomAndId].push_back(mint);
+            pindexNew->PrivacyData().mintedPubCoinsV2[denomAndId].push_back(mint);
         }
+        pindexNew->CompactPrivacyData();
     }
     else if (!fJustCheck) {
         sigmaState.AddBlock(pindexNew);
     }
+
+    if (fSigmaIndex && pblock && !fJustCheck) {
+        std::vector<std::pair<uint256, CSigmaMintIndexValue> > entries;
+        GetSigmaMintIndexEntries(*pblock, pindexNew->nHeight, false, entries);
+        if (!entries.empty() && !pblocktree->UpdateSigmaMintIndex(entries))
+            return state.Error("Failed to write sigma mint index");
+    }
     return true;
 }
 
@@ -506,6 +655,105 @@ void CSigmaTxInfo::Complete() {
     fInfoIsComplete = true;
 }
 
+// CSigmaSpendCheck
+
+void CSigmaSpendCheck::AddSpend(const sigma::CoinSpend *spend, const sigma::SpendMetaData &metaData, bool fPadding,
+        const uint256 &cacheEntry) {
+    this->spends.push_back(spend);
+    this->metaData.push_back(metaData);
+    this->fPadding.push_back(fPadding);
+    this->cacheEntries.push_back(cacheEntry);
+}
+
+bool CSigmaSpendCheck::operator()() {
+    bool fValid = spends.size() > 1 && sigma::CoinSpend::BatchVerify(SParams, *anonymitySet, spends, metaData, fPadding);
+    if (!fValid) {
+        if (spends.size() > 1)
+            LogPrintf("CSigmaSpendCheck: batch of %d spends failed, checking one by one\n", spends.size());
+
+        for (size_t i = 0; i < spends.size(); i++) {
+            if (!spends[i]->Verify(*anonymitySet, metaData[i], fPadding[i])) {
+                LogPrintf("CheckSigmaSpendTransaction: verification failed at block=%d, denomID=%d, pubcoinID=%d\n",
+                          nHeight, spends[i]->getDenomination(), nGroupId);
+                return false;
+            }
+        }
+    }
+
+    for (const uint256 &entry : cacheEntries)
+        sigmaVerificationCache.Set(entry);
+    return true;
+}
+
+void CSigmaSpendCheck::swap(CSigmaSpendCheck &check) {
+    std::swap(anonymitySet, check.anonymitySet);
+    spends.swap(check.spends);
+    metaData.swap(check.metaData);
+    fPadding.swap(check.fPadding);
+    cacheEntries.swap(check.cacheEntries);
+    std::swap(nGroupId, check.nGroupId);
+    std::swap(nHeight, check.nHeight);
+}
+
+// CSigmaSpendBatch
+
+bool CSigmaSpendBatch::HasAnonymitySet(const GroupKey &key) const {
+    return groups.count(key) != 0;
+}
+
+void CSigmaSpendBatch::Add(
+        const GroupKey &key,
+        std::vector<sigma::PublicCoin> &&anonymitySet,
+        std::unique_ptr<sigma::CoinSpend> spend,
+        const sigma::SpendMetaData &metaData,
+        bool fPadding,
+        const uint256 &cacheEntry) {
+    CPendingGroup &group = groups[key];
+    group.anonymitySet = std::move(anonymitySet);
+    group.spends.push_back(CPendingSpend{std::move(spend), metaData, fPadding, cacheEntry});
+}
+
+void CSigmaSpendBatch::Add(
+        const GroupKey &key,
+        std::unique_ptr<sigma::CoinSpend> spend,
+        const sigma::SpendMetaData &metaData,
+        bool fPadding,
+        const uint256 &cacheEntry) {
+    auto it = groups.find(key);
+    assert(it != groups.end());
+    it->second.spends.push_back(CPendingSpend{std::move(spend), metaData, fPadding, cacheEntry});
+}
+
+bool CSigmaSpendBatch::Verify(int nHeight) {
+    CComputeExecutor &executor = GetComputeExecutor();
+    size_t nWorkers = executor.GetConcurrency();
+    std::vector<CSigmaSpendCheck> vChecks;
+
+    for (const auto &group : groups) {
+        const std::vector<CPendingSpend> &spends = group.second.spends;
+        size_t nPerCheck = (spends.size() + nWorkers - 1) / nWorkers;
+
+        for (size_t begin = 0; begin < spends.size(); begin += nPerCheck) {
+            CSigmaSpendCheck check(&group.second.anonymitySet, std::get<1>(group.first), nHeight);
+            for (size_t i = begin; i < std::min(begin + nPerCheck, spends.size()); i++)
+                check.AddSpend(spends[i].spend.get(), spends[i].metaData, spends[i].fPadding, spends[i].cacheEntry);
+            vChecks.push_back(CSigmaSpendCheck());
+            vChecks.back().swap(check);
+        }
+    }
+
+    std::atomic<bool> fValid(true);
+    executor.ParallelFor(vChecks.size(), [&vChecks, &fValid](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd && fValid; i++) {
+            if (!vChecks[i]())
+                fValid = false;
+        }
+    }, 1);
+
+    groups.clear();
+    return fValid;
+}
+
 // CSigmaState
 
 CSigmaState::CSigmaState() {
@@ -547,17 +795,35 @@ int CSigmaState::AddMint(
     coinInfo.id = mintCoinGroupId;
     coinInfo.nHeight = index->nHeight;
     mintedPubCoins.insert(std::make_pair(pubCoin, coinInfo));
+    mintedPubCoinHashes.insert(std::make_pair(GetPubCoinValueHash(pubCoin.getValue()), pubCoin.getValue()));
+    AddCoinToGroup(std::make_pair(denomination, mintCoinGroupId), index->nHeight, pubCoin);
     return mintCoinGroupId;
 }
 
+void CSigmaState::AddCoinToGroup(
+        const pair<sigma::CoinDenomination, int> &denomAndId,
+        int nHeight,
+        const sigma::PublicCoin &pubCoin) {
+    CoinGroupCoins &groupCoins = coinGroupCoins[denomAndId];
+    // Keep the coins in affine form, so the spend proofs do not normalize
+    // them again on every verification
+    GroupElement value(pubCoin.getValue());
+    groupCoins.coins.emplace_back(value.normalize(), pubCoin.getDenomination());
+    if (groupCoins.blockEnds.empty() || groupCoins.blockEnds.back().first != nHeight)
+        groupCoins.blockEnds.push_back(std::make_pair(nHeight, groupCoins.coins.size()));
+    else
+        groupCoins.blockEnds.back().second = groupCoins.coins.size();
+}
+
 void CSigmaState::AddSpend(const Scalar &serial) {
     usedCoinSerials.insert(serial);
+    usedCoinSerialHashes.insert(std::make_pair(GetSerialHash(serial), serial));
 }
 
 void CSigmaState::AddBlock(CBlockIndex *index) {
     for(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int), vector<sigma::PublicCoin>) &pubCoins:
-            index->mintedPubCoinsV2) {
+            index->GetPrivacyData().mintedPubCoinsV2) {
         if (!pubCoins.second.empty()) {
             CoinGroupInfo& coinGroup = coinGroups[pubCoins.first];
 
@@ -574,11 +840,13 @@ void CSigmaState::AddBlock(CBlockIndex *index) {
             coinInfo.id = pubCoins.first.second;
             coinInfo.nHeight = index->nHeight;
             mintedPubCoins.insert(pair<sigma::PublicCoin, CMintedCoinInfo>(coin, coinInfo));
+            mintedPubCoinHashes.insert(std::make_pair(GetPubCoinValueHash(coin.getValue()), coin.getValue()));
+            AddCoinToGroup(pubCoins.first, index->nHeight, coin);
         }
     }
 
-    for(const Scalar &serial: index->spentSerialsV2) {
-        usedCoinSerials.insert(serial);
+    for(const Scalar &serial: index->GetPrivacyData().spentSerialsV2) {
+        AddSpend(serial);
     }
 }
 
@@ -586,31 +854,38 @@ void CSigmaState::RemoveBlock(CBlockIndex *index) {
     // roll back accumulator updates
     for(
         const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &coin:
-        index->mintedPubCoinsV2)
+        index->GetPrivacyData().mintedPubCoinsV2)
     {
+        if (coin.second.empty())
+            continue;
+
         CoinGroupInfo   &coinGroup = coinGroups[coin.first];
+        CoinGroupCoins  &groupCoins = coinGroupCoins[coin.first];
         int  nMintsToForget = coin.second.size();
 
         assert(coinGroup.nCoins >= nMintsToForget);
+        assert(!groupCoins.blockEnds.empty() && groupCoins.blockEnds.back().first == index->nHeight);
+
+        groupCoins.blockEnds.pop_back();
 
         if ((coinGroup.nCoins -= nMintsToForget) == 0) {
             // all the coins of this group have been erased, remove the group altogether
             coinGroups.erase(coin.first);
+            coinGroupCoins.erase(coin.first);
             // decrease pubcoin id for this denomination
             latestCoinIds[coin.first.first]--;
         }
         else {
-            // roll back lastBlock to previous position
-            do {
-                assert(coinGroup.lastBlock != coinGroup.firstBlock);
-                coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->mintedPubCoinsV2.count(coin.first) == 0);
+            // roll back lastBlock to previous block having coins of this group
+            assert(coinGroup.lastBlock != coinGroup.firstBlock);
+            coinGroup.lastBlock = coinGroup.lastBlock->GetAncestor(groupCoins.blockEnds.back().first);
+            groupCoins.coins.resize(groupCoins.blockEnds.back().second);
         }
     }
 
     // roll back mints
     for(const PAIRTYPE(PAIRTYPE(sigma::CoinDenomination, int),vector<sigma::PublicCoin>) &pubCoins:
-                  index->mintedPubCoinsV2) {
+                  index->GetPrivacyData().mintedPubCoinsV2) {
         for(const sigma::PublicCoin &coin: pubCoins.second) {
             auto coins = mintedPubCoins.equal_range(coin);
             auto coinIt = find_if(
@@ -621,14 +896,19 @@ void CSigmaState::RemoveBlock(CBlockIndex *index) {
                 });
             assert(coinIt != coins.second);
             mintedPubCoins.erase(coinIt);
+            mintedPubCoinHashes.erase(GetPubCoinValueHash(coin.getValue()));
         }
     }
-    index->mintedPubCoinsV2.clear();
     // roll back spends
-    for(const Scalar &serial: index->spentSerialsV2) {
+    for(const Scalar &serial: index->GetPrivacyData().spentSerialsV2) {
         usedCoinSerials.erase(serial);
+        usedCoinSerialHashes.erase(GetSerialHash(serial));
+    }
+    if (index->privacyData) {
+        index->privacyData->mintedPubCoinsV2.clear();
+        index->privacyData->spentSerialsV2.clear();
+        index->CompactPrivacyData();
     }
-    index->spentSerialsV2.clear();
 }
 
 bool CSigmaState::GetCoinGroupInfo(
@@ -644,6 +924,51 @@ bool CSigmaState::GetCoinGroupInfo(
     return true;
 }
 
+bool CSigmaState::GetAnonymitySet(
+        sigma::CoinDenomination denomination,
+        int group_id,
+        const uint256 &accumulatorBlockHash,
+        CAnonymitySet &result) {
+    std::pair<sigma::CoinDenomination, int> key =
+        std::make_pair(denomination, group_id);
+    auto groupIt = coinGroups.find(key);
+    auto coinsIt = coinGroupCoins.find(key);
+    if (groupIt == coinGroups.end() || coinsIt == coinGroupCoins.end())
+        return false;
+
+    const CoinGroupInfo &coinGroup = groupIt->second;
+    const CoinGroupCoins &groupCoins = coinsIt->second;
+
+    // use coins minted up to the accumulator block if it's one of the blocks of the group
+    int nHeight = coinGroup.firstBlock->nHeight;
+    LOCK(cs_main);
+    BlockMap::const_iterator mi = mapBlockIndex.find(accumulatorBlockHash);
+    if (mi != mapBlockIndex.end()) {
+        CBlockIndex *accumulatorBlock = mi->second;
+        if (accumulatorBlock->nHeight >= coinGroup.firstBlock->nHeight
+                && coinGroup.lastBlock->GetAncestor(accumulatorBlock->nHeight) == accumulatorBlock)
+            nHeight = accumulatorBlock->nHeight;
+    }
+
+    auto blockEnd = std::upper_bound(groupCoins.blockEnds.begin(), groupCoins.blockEnds.end(), nHeight,
+        [](int height, const std::pair<int, size_t> &block) { return height < block.first; });
+    size_t nBlocks = blockEnd - groupCoins.blockEnds.begin();
+    uint256 tipBlockHash;
+    if (nBlocks > 0)
+        tipBlockHash = coinGroup.lastBlock->GetAncestor(groupCoins.blockEnds[nBlocks - 1].first)->GetBlockHash();
+    result = CAnonymitySet(&groupCoins, nBlocks, tipBlockHash);
+    return true;
+}
+
+void CSigmaState::CAnonymitySet::CopyTo(std::vector<sigma::PublicCoin> &coins_out) const {
+    for (size_t i = nBlocks; i-- > 0; ) {
+        size_t blockBegin = i == 0 ? 0 : group->blockEnds[i - 1].second;
+        coins_out.insert(coins_out.end(),
+                group->coins.begin() + blockBegin,
+                group->coins.begin() + group->blockEnds[i].second);
+    }
+}
+
 bool CSigmaState::IsUsedCoinSerial(const Scalar &coinSerial) {
     return usedCoinSerials.count(coinSerial) != 0;
 }
@@ -662,33 +987,23 @@ int CSigmaState::GetCoinSetForSpend(
 
     pair<sigma::CoinDenomination, int> denomAndId = std::make_pair(denomination, coinGroupID);
 
-    if (coinGroups.count(denomAndId) == 0)
+    auto groupIt = coinGroups.find(denomAndId);
+    auto coinsIt = coinGroupCoins.find(denomAndId);
+    if (groupIt == coinGroups.end() || coinsIt == coinGroupCoins.end())
         return 0;
 
-    CoinGroupInfo coinGroup = coinGroups[denomAndId];
-
-    int numberOfCoins = 0;
-    for (CBlockIndex *block = coinGroup.lastBlock;
-            ;
-            block = block->pprev) {
-        if (block->mintedPubCoinsV2[denomAndId].size() > 0) {
-            if (block->nHeight <= maxHeight) {
-                if (numberOfCoins == 0) {
-                    // latest block satisfying given conditions
-                    // remember block hash
-                    blockHash_out = block->GetBlockHash();
-                }
-                numberOfCoins += block->mintedPubCoinsV2[denomAndId].size();
-                coins_out.insert(coins_out.end(),
-                        block->mintedPubCoinsV2[denomAndId].begin(),
-                        block->mintedPubCoinsV2[denomAndId].end());
-            }
-        }
-        if (block == coinGroup.firstBlock) {
-            break ;
-        }
-    }
-    return numberOfCoins;
+    const CoinGroupCoins &groupCoins = coinsIt->second;
+    auto blockEnd = std::upper_bound(groupCoins.blockEnds.begin(), groupCoins.blockEnds.end(), maxHeight,
+        [](int height, const std::pair<int, size_t> &block) { return height < block.first; });
+    if (blockEnd == groupCoins.blockEnds.begin())
+        return 0;
+
+    // latest block satisfying given conditions
+    blockHash_out = groupIt->second.lastBlock->GetAncestor((blockEnd - 1)->first)->GetBlockHash();
+
+    CAnonymitySet anonymitySet(&groupCoins, blockEnd - groupCoins.blockEnds.begin(), blockHash_out);
+    anonymitySet.CopyTo(coins_out);
+    return anonymitySet.size();
 }
 
 std::pair<int, int> CSigmaState::GetMintedCoinHeightAndId(
@@ -761,12 +1076,128 @@ bool CSigmaState::CanAddMintToMempool(const sigma::PublicCoin &coinMint) {
 
 void CSigmaState::Reset() {
     coinGroups.clear();
+    coinGroupCoins.clear();
     usedCoinSerials.clear();
+    usedCoinSerialHashes.clear();
     latestCoinIds.clear();
     mintedPubCoins.clear();
+    mintedPubCoinHashes.clear();
     mempoolCoinSerials.clear();
 }
 
+void CSigmaState::WriteSnapshot(CDataStream &stream) const {
+    stream << (uint64_t)latestCoinIds.size();
+    for (const auto &latestCoinId : latestCoinIds)
+        stream << latestCoinId;
+
+    unsigned char buffer[GroupElement::affine_size];
+    stream << (uint64_t)coinGroups.size();
+    for (const auto &coinGroup : coinGroups) {
+        stream << coinGroup.first;
+        stream << (coinGroup.second.firstBlock ? coinGroup.second.firstBlock->nHeight : -1);
+        stream << (coinGroup.second.lastBlock ? coinGroup.second.lastBlock->nHeight : -1);
+        stream << coinGroup.second.nCoins;
+
+        // coins are stored affine, so that reading them back needs no square root
+        static const CoinGroupCoins noCoins;
+        auto groupCoinsIt = coinGroupCoins.find(coinGroup.first);
+        const CoinGroupCoins &groupCoins = groupCoinsIt != coinGroupCoins.end() ? groupCoinsIt->second : noCoins;
+        stream << (uint64_t)groupCoins.blockEnds.size();
+        for (const auto &blockEnd : groupCoins.blockEnds)
+            stream << blockEnd.first << (uint64_t)blockEnd.second;
+        stream << (uint64_t)groupCoins.coins.size();
+        for (const sigma::PublicCoin &coin : groupCoins.coins) {
+            coin.getValue().serialize_affine(buffer);
+            stream.write((const char *)buffer, sizeof(buffer));
+        }
+    }
+
+    stream << (uint64_t)usedCoinSerialHashes.size();
+    for (const auto &serial : usedCoinSerialHashes)
+        stream << serial.first << serial.second;
+}
+
+bool CSigmaState::ReadSnapshot(CDataStream &stream, CChain *chain) {
+    Reset();
+
+    uint64_t nLatestCoinIds;
+    stream >> nLatestCoinIds;
+    while (nLatestCoinIds--) {
+        pair<sigma::CoinDenomination, int> latestCoinId;
+        stream >> latestCoinId;
+        latestCoinIds[latestCoinId.first] = latestCoinId.second;
+    }
+
+    unsigned char buffer[GroupElement::affine_size];
+    uint64_t nCoinGroups;
+    stream >> nCoinGroups;
+    while (nCoinGroups--) {
+        pair<sigma::CoinDenomination, int> denomAndId;
+        int nFirstHeight, nLastHeight;
+        stream >> denomAndId >> nFirstHeight >> nLastHeight;
+
+        CoinGroupInfo &coinGroup = coinGroups[denomAndId];
+        stream >> coinGroup.nCoins;
+        if (nFirstHeight > chain->Height() || nLastHeight > chain->Height())
+            return false;
+        coinGroup.firstBlock = nFirstHeight < 0 ? NULL : (*chain)[nFirstHeight];
+        coinGroup.lastBlock = nLastHeight < 0 ? NULL : (*chain)[nLastHeight];
+
+        CoinGroupCoins &groupCoins = coinGroupCoins[denomAndId];
+        uint64_t nBlockEnds, nCoins;
+        stream >> nBlockEnds;
+        groupCoins.blockEnds.reserve(nBlockEnds);
+        while (nBlockEnds--) {
+            int nHeight;
+            uint64_t nEnd;
+            stream >> nHeight >> nEnd;
+            // both the heights and the offsets must strictly increase, as they do when
+            // the group is built block by block
+            int nPrevHeight = groupCoins.blockEnds.empty() ? -1 : groupCoins.blockEnds.back().first;
+            size_t nPrevEnd = groupCoins.blockEnds.empty() ? 0 : groupCoins.blockEnds.back().second;
+            if (nHeight <= nPrevHeight || nHeight > chain->Height() || nEnd <= nPrevEnd)
+                return false;
+            groupCoins.blockEnds.push_back(std::make_pair(nHeight, (size_t)nEnd));
+        }
+        stream >> nCoins;
+        if (nCoins != (groupCoins.blockEnds.empty() ? 0 : groupCoins.blockEnds.back().second))
+            return false;
+
+        groupCoins.coins.reserve(nCoins);
+        auto blockEnd = groupCoins.blockEnds.begin();
+        for (size_t i = 0; i < nCoins; ++i) {
+            while (blockEnd->second <= i)
+                ++blockEnd;
+
+            GroupElement value;
+            stream.read((char *)buffer, sizeof(buffer));
+            value.deserialize_affine(buffer);
+            uint256 valueHash = GetPubCoinValueHash(value);
+
+            sigma::PublicCoin coin(value, denomAndId.first);
+            CMintedCoinInfo coinInfo;
+            coinInfo.denomination = denomAndId.first;
+            coinInfo.id = denomAndId.second;
+            coinInfo.nHeight = blockEnd->first;
+            groupCoins.coins.push_back(coin);
+            mintedPubCoins.insert(std::make_pair(coin, coinInfo));
+            mintedPubCoinHashes.insert(std::make_pair(valueHash, value));
+        }
+    }
+
+    uint64_t nSerials;
+    stream >> nSerials;
+    while (nSerials--) {
+        uint256 serialHash;
+        Scalar serial;
+        stream >> serialHash >> serial;
+        usedCoinSerials.insert(serial);
+        usedCoinSerialHashes.insert(std::make_pair(serialHash, serial));
+    }
+
+    return true;
+}
+
 CSigmaState* CSigmaState::GetSigmaState() {
     return &sigmaState;
 }
@@ -781,28 +1212,33 @@ int CSigmaState::GetLatestCoinID(sigma::CoinDenomination denomination) const {
 }
 
 bool CSigmaState::HasCoinHash(GroupElement &pubCoinValue, const uint256 &pubCoinValueHash) {
-    for ( auto it = mintedPubCoins.begin(); it != mintedPubCoins.end(); ++it ){
-        sigma::PublicCoin pubCoin = (*it).first;
-        if(GetPubCoinValueHash(pubCoin.getValue())==pubCoinValueHash){
-            pubCoinValue = pubCoin.getValue();
-            return true;
-        }
-    }
-    return false;
+    auto it = mintedPubCoinHashes.find(pubCoinValueHash);
+    if (it == mintedPubCoinHashes.end())
+        return false;
+    pubCoinValue = it->second;
+    return true;
 }
 
 bool CSigmaState::IsUsedCoinSerialHash(Scalar &coinSerial, const uint256 &coinSerialHash) {
-    for ( auto it = usedCoinSerials.begin(); it != usedCoinSerials.end(); ++it ){
-        if(GetSerialHash(*it)==coinSerialHash){
-            coinSerial = *it;
-            return true;
-        }
-    }
-    return false;
+    auto it = usedCoinSerialHashes.find(coinSerialHash);
+    if (it == usedCoinSerialHashes.end())
+        return false;
+    coinSerial = it->second;
+    return true;
 }
 
 
+bool SigmaGetMintIndexValue(const uint256& pubCoinValueHash, CSigmaMintIndexValue& value) {
+    return fSigmaIndex && pblocktree->ReadSigmaMintIndex(pubCoinValueHash, value);
+}
+
 bool SigmaGetMintTxHash(uint256& txHash, GroupElement pubCoinValue) {
+    CSigmaMintIndexValue mintIndexValue;
+    if (SigmaGetMintIndexValue(GetPubCoinValueHash(pubCoinValue), mintIndexValue)) {
+        txHash = mintIndexValue.txid;
+        return true;
+    }
+
     int mintHeight = 0;
     int coinId = 0;
 
@@ -856,6 +1292,12 @@ bool SigmaGetMintTxHash(uint256& txHash, GroupElement pubCoinValue) {
 }
 
 bool SigmaGetMintTxHash(uint256& txHash, uint256 pubCoinValueHash) {
+    CSigmaMintIndexValue mintIndexValue;
+    if (SigmaGetMintIndexValue(pubCoinValueHash, mintIndexValue)) {
+        txHash = mintIndexValue.txid;
+        return true;
+    }
+
     GroupElement pubCoinValue;
     if(!sigmaState.HasCoinHash(pubCoinValue, pubCoinValueHash)){
         return false;
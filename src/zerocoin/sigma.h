@@ -14,13 +14,20 @@
 #include <libzerocoin/Zerocoin.h>
 #include <sigma/coin.h>
 #include <sigma/coinspend.h>
+#include <map>
+#include <memory>
+#include <tuple>
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
 #include <net.h>
+#include <sigmaindex.h>
 
 #define COINS_PER_ID 15000
 
+// Default size of the cache of verified sigma spends, in MiB
+static const int64_t DEFAULT_MAX_SIGMA_CACHE_SIZE = 4;
+
 // sigma parameters
 extern sigma::Params *SParams;
 
@@ -49,9 +56,92 @@ struct CMintMeta
     bool watchOnly;
 };
 
+// Initialize the cache of successfully verified sigma spends, sized by -maxsigmacachesize
+void InitSigmaVerificationCache();
+
 uint256 GetSerialHash(const Scalar& bnSerial);
 uint256 GetPubCoinValueHash(const GroupElement& bnValue);
 
+/*
+ * Verification of some of the spends made against one anonymity set, run on the compute
+ * executor. The anonymity set and the spends are owned by the CSigmaSpendBatch the
+ * check comes from.
+ */
+class CSigmaSpendCheck {
+public:
+    CSigmaSpendCheck(): anonymitySet(nullptr), nGroupId(0), nHeight(0) {}
+    CSigmaSpendCheck(const std::vector<sigma::PublicCoin> *anonymitySetIn, int nGroupIdIn, int nHeightIn):
+        anonymitySet(anonymitySetIn), nGroupId(nGroupIdIn), nHeight(nHeightIn) {}
+
+    // cacheEntry goes to the sigma verification cache once the spend is verified
+    void AddSpend(const sigma::CoinSpend *spend, const sigma::SpendMetaData &metaData, bool fPadding,
+            const uint256 &cacheEntry);
+
+    bool operator()();
+
+    void swap(CSigmaSpendCheck &check);
+
+private:
+    const std::vector<sigma::PublicCoin> *anonymitySet;
+    std::vector<const sigma::CoinSpend*> spends;
+    std::vector<sigma::SpendMetaData> metaData;
+    std::vector<bool> fPadding;
+    std::vector<uint256> cacheEntries;
+    int nGroupId;
+    int nHeight;
+};
+
+/*
+ * Sigma spends waiting for proof verification. Spends made against the same anonymity
+ * set (denomination, coin group id and number of coins in the set) are verified together
+ * with one multi-exponentiation.
+ */
+class CSigmaSpendBatch {
+public:
+    typedef std::tuple<sigma::CoinDenomination, int, size_t> GroupKey;
+
+    // Returns true if an anonymity set for the given key has already been added
+    bool HasAnonymitySet(const GroupKey &key) const;
+
+    // Anonymity set has to be supplied with the first spend for every key
+    void Add(const GroupKey &key,
+             std::vector<sigma::PublicCoin> &&anonymitySet,
+             std::unique_ptr<sigma::CoinSpend> spend,
+             const sigma::SpendMetaData &metaData,
+             bool fPadding,
+             const uint256 &cacheEntry);
+
+    void Add(const GroupKey &key,
+             std::unique_ptr<sigma::CoinSpend> spend,
+             const sigma::SpendMetaData &metaData,
+             bool fPadding,
+             const uint256 &cacheEntry);
+
+    // Verify all the pending spends and clear the batch. The groups are spread over
+    // the sigma check queue, big ones in as many parts as there are workers. If a part
+    // fails every spend of it is verified on its own to find the offending one.
+    bool Verify(int nHeight);
+
+    bool IsEmpty() const { return groups.empty(); }
+
+    void Clear() { groups.clear(); }
+
+private:
+    struct CPendingSpend {
+        std::unique_ptr<sigma::CoinSpend> spend;
+        sigma::SpendMetaData metaData;
+        bool fPadding;
+        uint256 cacheEntry;
+    };
+
+    struct CPendingGroup {
+        std::vector<sigma::PublicCoin> anonymitySet;
+        std::vector<CPendingSpend> spends;
+    };
+
+    std::map<GroupKey, CPendingGroup> groups;
+};
+
 class CSigmaTxInfo {
 public: 
     // all the sigma transactions encountered so far
@@ -63,6 +153,9 @@ public:
     // serial for every spend (map from serial to denomination)
     std::unordered_map<Scalar, int, sigma::CScalarHash> spentSerials;
 
+    // spends of the block waiting for proof verification
+    CSigmaSpendBatch spendBatch;
+
     // information about transactions in the block is complete
     bool fInfoIsComplete;
 
@@ -72,8 +165,21 @@ public:
     void Complete();
 };
 
+// Fields of a sigma spend input other than the proof
+struct CSigmaSpendHeader {
+    uint32_t groupId;
+    int version;
+    Scalar serial;
+    sigma::CoinDenomination denomination;
+    uint256 accumulatorBlockHash;
+
+    int64_t getIntDenomination() const;
+};
+
 secp_primitives::GroupElement ParseSigmaMintScript(const CScript& script);
 std::pair<std::unique_ptr<sigma::CoinSpend>, uint32_t> ParseSigmaSpend(const CTxIn& in);
+// Reads a spend input like ParseSigmaSpend but skips over the proof instead of decoding it
+CSigmaSpendHeader ParseSigmaSpendHeader(const CTxIn& in);
 
 bool CheckSigmaTransaction(
   const CTransaction &tx,
@@ -84,7 +190,8 @@ bool CheckSigmaTransaction(
   bool isCheckWallet,
   CSigmaTxInfo *sigmaTxInfo);
 
-void DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
+// Returns false if the -sigmaindex entries of the block could not be erased
+bool DisconnectTipSigma(CBlock &block, CBlockIndex *pindexDelete);
 
 bool ConnectBlockSigma(
   CValidationState& state,
@@ -114,6 +221,39 @@ public:
         int nCoins;
     };
 
+    // Coins of a coin group in the order they were minted, in affine form. The anonymity set as of any
+    // block of the group is a prefix of this array.
+    struct CoinGroupCoins {
+        std::vector<sigma::PublicCoin> coins;
+        // heights of the blocks that minted coins of the group, each with the offset just
+        // past its last coin
+        std::vector<std::pair<int, size_t>> blockEnds;
+    };
+
+    // Anonymity set of a coin group as of some block. It references coins owned by the
+    // state and is only valid until the state is changed.
+    class CAnonymitySet {
+    public:
+        CAnonymitySet() : group(NULL), nBlocks(0) {}
+        CAnonymitySet(const CoinGroupCoins *group, size_t nBlocks, const uint256 &tipBlockHash) :
+            group(group), nBlocks(nBlocks), tipBlockHash(tipBlockHash) {}
+
+        size_t size() const { return nBlocks == 0 ? 0 : group->blockEnds[nBlocks - 1].second; }
+
+        bool empty() const { return size() == 0; }
+
+        // Append the coins to coins_out in the order spend proofs use, newest block first
+        void CopyTo(std::vector<sigma::PublicCoin> &coins_out) const;
+
+        // Hash of the newest block with coins in the set
+        const uint256 &GetTipBlockHash() const { return tipBlockHash; }
+
+    private:
+        const CoinGroupCoins *group;
+        size_t nBlocks;
+        uint256 tipBlockHash;
+    };
+
     struct CMintedCoinInfo {
         sigma::CoinDenomination denomination;
 
@@ -151,6 +291,12 @@ public:
     bool GetCoinGroupInfo(sigma::CoinDenomination denomination,
         int group_id, CoinGroupInfo &result);
 
+    // Query anonymity set for a spend made against given accumulator block. Like the spend
+    // verification always did, falls back to the first block of the group if the accumulator
+    // block is not part of it.
+    bool GetAnonymitySet(sigma::CoinDenomination denomination,
+        int group_id, const uint256 &accumulatorBlockHash, CAnonymitySet &result);
+
     // Query if the coin serial was previously used
     bool IsUsedCoinSerial(const Scalar& coinSerial);
     bool IsUsedCoinSerialHash(Scalar &coinSerial, const uint256 &coinSerialHash);
@@ -176,6 +322,12 @@ public:
     // Reset to initial values
     void Reset();
 
+    // Write the mints and spends of the chain to a startup snapshot, and read them back in place
+    // of the current state. Coin group blocks are stored by height, so the snapshot is only valid
+    // for the chain it was written at. Returns false if it doesn't fit the chain.
+    void WriteSnapshot(CDataStream &stream) const;
+    bool ReadSnapshot(CDataStream &stream, CChain *chain);
+
     // Check if there is a conflicting tx in the blockchain or mempool
     bool CanAddSpendToMempool(const Scalar& coinSerial);
 
@@ -214,9 +366,15 @@ public:
 
 
 private:
+    // Append minted coin to the coins of its group
+    void AddCoinToGroup(const pair<sigma::CoinDenomination, int> &denomAndId, int nHeight, const sigma::PublicCoin &pubCoin);
+
     // Collection of coin groups. Map from <denomination,id> to CoinGroupInfo structure
     std::unordered_map<pair<sigma::CoinDenomination, int>, CoinGroupInfo, pairhash> coinGroups;
 
+    // Minted coins of every coin group, keyed by <denomination,id>
+    std::unordered_map<pair<sigma::CoinDenomination, int>, CoinGroupCoins, pairhash> coinGroupCoins;
+
     // Set of all minted pubCoin values, keyed by the public coin.
     // Used for checking if the given coin already exists.
     unordered_map<sigma::PublicCoin, CMintedCoinInfo, sigma::CPublicCoinHash> mintedPubCoins;
@@ -227,6 +385,11 @@ private:
     // Set of all used coin serials.
     std::unordered_set<Scalar, sigma::CScalarHash> usedCoinSerials;
 
+    // Minted pubCoin values and used coin serials keyed by GetPubCoinValueHash() / GetSerialHash(),
+    // kept next to mintedPubCoins and usedCoinSerials for HasCoinHash() and IsUsedCoinSerialHash().
+    std::unordered_map<uint256, GroupElement, BlockHasher> mintedPubCoinHashes;
+    std::unordered_map<uint256, Scalar, BlockHasher> usedCoinSerialHashes;
+
     // serials of spends currently in the mempool mapped to tx hashes
     std::unordered_map<Scalar, uint256, sigma::CScalarHash> mempoolCoinSerials;
 
@@ -237,6 +400,9 @@ private:
 
 bool IsSigmaAllowed();
 
+// Look the mint up in the -sigmaindex, returns false if the index is disabled
+bool SigmaGetMintIndexValue(const uint256& pubCoinValueHash, CSigmaMintIndexValue& value);
+
 bool SigmaGetMintTxHash(uint256& txHash, uint256 pubCoinValueHash);
 bool SigmaGetMintTxHash(uint256& txHash, GroupElement pubCoinValue);
 
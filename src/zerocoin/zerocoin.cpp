@@ -1,6 +1,7 @@
 #include "zerocoin.h"
 #include "timedata.h"
 #include "util.h"
+#include "executor.h"
 #include "base58.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
@@ -41,6 +42,35 @@ static bool CheckZerocoinSpendSerial(CValidationState &state, CZerocoinTxInfo *z
     return true;
 }
 
+// Enumerate all the accumulator changes of the coin group seen in the blockchain starting with
+// the given block, or check only that one if the spend names the block of its accumulator.
+// In most cases the latest accumulator value will be used for verification
+static bool VerifyZerocoinSpend(const libzerocoin::CoinSpend &spend,
+                                const libzerocoin::SpendMetaData &metaData,
+                                libzerocoin::CoinDenomination denomination,
+                                int pubcoinId,
+                                const CBlockIndex *index,
+                                const CBlockIndex *firstBlock,
+                                bool fHasBlockHash) {
+    pair<int,int> denominationAndId = make_pair(denomination, pubcoinId);
+    bool passVerify = false;
+    do {
+        if (index->GetPrivacyData().accumulatorChanges.count(denominationAndId) > 0) {
+            libzerocoin::Accumulator accumulator(ZCParams,
+                                                 index->GetPrivacyData().accumulatorChanges.at(denominationAndId).first,
+                                                 denomination);
+            passVerify = spend.Verify(accumulator, metaData);
+        }
+
+        if (index == firstBlock || fHasBlockHash)
+            break;
+        else
+            index = index->pprev;
+    } while (!passVerify);
+
+    return passVerify;
+}
+
 bool CheckSpendZerocoinTransaction(const CTransaction &tx,
                                 libzerocoin::CoinDenomination targetDenomination,
                                 CValidationState &state,
@@ -77,9 +107,9 @@ bool CheckSpendZerocoinTransaction(const CTransaction &tx,
     CDataStream serializedCoinSpend((const char *)&*(txin.scriptSig.begin() + 4),
                                     (const char *)&*txin.scriptSig.end(),
                                     SER_NETWORK, PROTOCOL_VERSION);
-    libzerocoin::CoinSpend newSpend(ZCParams, serializedCoinSpend);
+    std::unique_ptr<libzerocoin::CoinSpend> newSpend(new libzerocoin::CoinSpend(ZCParams, serializedCoinSpend));
 
-    int spendVersion = newSpend.getVersion();
+    int spendVersion = newSpend->getVersion();
     if (spendVersion < ZEROCOIN_VERSION_1 || (forceSpendLink && spendVersion != ZEROCOIN_VERSION_REDEEM)) {
         return state.DoS(100,
                          false,
@@ -89,7 +119,7 @@ bool CheckSpendZerocoinTransaction(const CTransaction &tx,
 
     if(forceSpendLink){
         //check if pubcoin is real
-        const CBigNum& bnPubcoin = newSpend.getPubcoinValue();
+        const CBigNum& bnPubcoin = newSpend->getPubcoinValue();
         if ((!isVerifyDB) && !zerocoinState.HasCoin(bnPubcoin))
             return state.DoS(100,
                              false,
@@ -105,8 +135,8 @@ bool CheckSpendZerocoinTransaction(const CTransaction &tx,
                              "CheckSpendZerocoinTransaction(): Could not find pubcoin denom");
         }
 
-        if(linkDenom != newSpend.getDenomination()){
-            LogPrintf("CheckSpendZerocoinTransaction(): Spending %d, Actual %d \n", newSpend.getDenomination(), linkDenom);
+        if(linkDenom != newSpend->getDenomination()){
+            LogPrintf("CheckSpendZerocoinTransaction(): Spending %d, Actual %d \n", newSpend->getDenomination(), linkDenom);
             return state.DoS(100,
                              false,
                              REJECT_MALFORMED,
@@ -115,7 +145,7 @@ bool CheckSpendZerocoinTransaction(const CTransaction &tx,
 
     }
 
-    newSpend.setVersion(spendVersion);
+    newSpend->setVersion(spendVersion);
 
 
 
@@ -141,60 +171,56 @@ bool CheckSpendZerocoinTransaction(const CTransaction &tx,
     if (!zerocoinState.GetCoinGroupInfo(targetDenomination, pubcoinId, coinGroup))
         return state.DoS(100, false, NO_MINT_ZEROCOIN, "CheckSpendZerocoinTransaction: Error: no coins were minted with such parameters at height %d", nHeight);
 
-    bool passVerify = false;
     CBlockIndex *index = coinGroup.lastBlock;
-    pair<int,int> denominationAndId = make_pair(targetDenomination, pubcoinId);
-
-
-    bool spendHasBlockHash;
+    bool spendHasBlockHash = false;
 
     // Zerocoin  transaction can cointain block hash of the last mint tx seen at the moment of spend. It speeds
     // up verification
-    if (spendVersion >= ZEROCOIN_VERSION_1 && !newSpend.getAccumulatorBlockHash().IsNull()) {
+    if (spendVersion >= ZEROCOIN_VERSION_1 && !newSpend->getAccumulatorBlockHash().IsNull()) {
         spendHasBlockHash = true;
-        uint256 accumulatorBlockHash = newSpend.getAccumulatorBlockHash();
+        uint256 accumulatorBlockHash = newSpend->getAccumulatorBlockHash();
 
         // find index for block with hash of accumulatorBlockHash or set index to the coinGroup.firstBlock if not found
         while (index != coinGroup.firstBlock && index->GetBlockHash() != accumulatorBlockHash)
             index = index->pprev;
     }
 
-    // Enumerate all the accumulator changes seen in the blockchain starting with the latest block
-    // In most cases the latest accumulator value will be used for verification
-    do {
-        if (index->accumulatorChanges.count(denominationAndId) > 0) {
-            libzerocoin::Accumulator accumulator(ZCParams,
-                                                 index->accumulatorChanges[denominationAndId].first,
-                                                 targetDenomination);
-            //LogPrintf("CheckSpendZerocoinTransaction: accumulator=%s\n", accumulator.getValue().ToString().substr(0,15));
-            passVerify = newSpend.Verify(accumulator, newMetadata);
-
-        }
-
-        if (index == coinGroup.firstBlock || spendHasBlockHash)
-            break;
-        else
-            index = index->pprev;
-    } while (!passVerify);
+    // Proofs of the spends of a block are skipped below -assumevalid, or verified all at once
+    // when the whole block has been checked
+    bool fBlockCheck = zerocoinTxInfo && !zerocoinTxInfo->fInfoIsComplete && !isVerifyDB && !isCheckWallet;
+    CBigNum serial = newSpend->getCoinSerialNumber();
+    libzerocoin::CoinDenomination spendDenomination = newSpend->getDenomination();
+    bool passVerify;
+    if (fBlockCheck && !zerocoinTxInfo->fCheckProofs) {
+        passVerify = true;
+    }
+    else if (fBlockCheck && fZerocoinVerifyParallel) {
+        zerocoinTxInfo->spendBatch.Add(std::move(newSpend), newMetadata, targetDenomination, pubcoinId,
+                index, coinGroup.firstBlock, spendHasBlockHash);
+        passVerify = true;
+    }
+    else {
+        passVerify = VerifyZerocoinSpend(*newSpend, newMetadata, targetDenomination, pubcoinId,
+                index, coinGroup.firstBlock, spendHasBlockHash);
+    }
 
     if (passVerify) {
 
-        CBigNum serial = newSpend.getCoinSerialNumber();
         // do not check for duplicates in case we've seen exact copy of this tx in this block before
         if (zerocoinTxInfo && zerocoinTxInfo->zcTransactions.count(hashTx) < 1) {
-            if (!CheckZerocoinSpendSerial(state, zerocoinTxInfo, newSpend.getDenomination(), serial, nHeight, false))
+            if (!CheckZerocoinSpendSerial(state, zerocoinTxInfo, spendDenomination, serial, nHeight, false))
                 return state.DoS(100, error("CheckZerocoinTransaction : invalid zerocoin spend serial"));
         }
         //batching transactions, make sure the same serial is not used twice
         else if(zerocoinTxInfo && tx.vout.size() > 1){
-            if (!CheckZerocoinSpendSerial(state, zerocoinTxInfo, newSpend.getDenomination(), serial, nHeight, false))
+            if (!CheckZerocoinSpendSerial(state, zerocoinTxInfo, spendDenomination, serial, nHeight, false))
                 return state.DoS(100, error("CheckZerocoinTransaction : invalid zerocoin spend, serial used twice"));
         }
 
         if(!isVerifyDB && !isCheckWallet) {
             if (zerocoinTxInfo && !zerocoinTxInfo->fInfoIsComplete) {
                 // add spend information to the index
-                zerocoinTxInfo->spentSerials[serial] = (int)newSpend.getDenomination();
+                zerocoinTxInfo->spentSerials[serial] = (int)spendDenomination;
                 zerocoinTxInfo->zcTransactions.insert(hashTx);
 
             }
@@ -451,10 +477,11 @@ bool ConnectBlockGhost(CValidationState &state, const CChainParams &chainparams,
     // Add zerocoin transaction information to index
     if (pblock && pblock->zerocoinTxInfo) {
 
-        pindexNew->spentSerials.clear();
+        if (pindexNew->privacyData)
+            pindexNew->privacyData->spentSerials.clear();
 
         BOOST_FOREACH(const PAIRTYPE(CBigNum,int) &serial, pblock->zerocoinTxInfo->spentSerials) {
-            pindexNew->spentSerials.insert(serial.first);
+            pindexNew->PrivacyData().spentSerials.insert(serial.first);
             if (!CheckZerocoinSpendSerial(state, pblock->zerocoinTxInfo.get(), (libzerocoin::CoinDenomination)serial.second, serial.first, pindexNew->nHeight, true))
                 return false;
             zerocoinState.AddSpend(serial.first);
@@ -469,7 +496,7 @@ bool ConnectBlockGhost(CValidationState &state, const CChainParams &chainparams,
             //LogPrintf("ConnectTipZC: mint added denomination=%d, id=%d\n", denomination, mintId);
             pair<int,int> denomAndId = make_pair(denomination, mintId);
 
-            pindexNew->mintedPubCoins[denomAndId].push_back(mint.second);
+            pindexNew->PrivacyData().mintedPubCoins[denomAndId].push_back(mint.second);
 
             CZerocoinState::CoinGroupInfo coinGroupInfo;
             zerocoinState.GetCoinGroupInfo(denomination, mintId, coinGroupInfo);
@@ -480,15 +507,17 @@ bool ConnectBlockGhost(CValidationState &state, const CChainParams &chainparams,
                                                  (libzerocoin::CoinDenomination)denomination);
             accumulator += pubCoin;
 
-            if (pindexNew->accumulatorChanges.count(denomAndId) > 0) {
-                pair<CBigNum,int> &accChange = pindexNew->accumulatorChanges[denomAndId];
+            map<pair<int,int>, pair<CBigNum,int>> &accumulatorChanges = pindexNew->PrivacyData().accumulatorChanges;
+            if (accumulatorChanges.count(denomAndId) > 0) {
+                pair<CBigNum,int> &accChange = accumulatorChanges[denomAndId];
                 accChange.first = accumulator.getValue();
                 accChange.second++;
             }
             else {
-                pindexNew->accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
+                accumulatorChanges[denomAndId] = make_pair(accumulator.getValue(), 1);
             }
         }
+        pindexNew->CompactPrivacyData();
     }
     else {
         zerocoinState.AddBlock(pindexNew);
@@ -547,6 +576,37 @@ void CZerocoinTxInfo::Complete() {
     fInfoIsComplete = true;
 }
 
+// CZerocoinSpendBatch
+
+void CZerocoinSpendBatch::Add(
+        std::unique_ptr<libzerocoin::CoinSpend> spend,
+        const libzerocoin::SpendMetaData &metaData,
+        libzerocoin::CoinDenomination denomination,
+        int pubcoinId,
+        const CBlockIndex *lastBlock,
+        const CBlockIndex *firstBlock,
+        bool fHasBlockHash) {
+    spends.push_back(CPendingSpend{std::move(spend), metaData, denomination, pubcoinId, lastBlock, firstBlock, fHasBlockHash});
+}
+
+bool CZerocoinSpendBatch::Verify(int nHeight) {
+    std::atomic<bool> fValid(true);
+    GetComputeExecutor().ParallelFor(spends.size(), [this, nHeight, &fValid](size_t nBegin, size_t nEnd) {
+        for (size_t i = nBegin; i < nEnd && fValid; i++) {
+            const CPendingSpend &pending = spends[i];
+            if (!VerifyZerocoinSpend(*pending.spend, pending.metaData, pending.denomination, pending.pubcoinId,
+                        pending.lastBlock, pending.firstBlock, pending.fHasBlockHash)) {
+                LogPrintf("CZerocoinSpendBatch: verification failed at block=%d, denom=%d, pubcoinID=%d\n",
+                          nHeight, (int)pending.denomination, pending.pubcoinId);
+                fValid = false;
+            }
+        }
+    }, 1);
+
+    spends.clear();
+    return fValid;
+}
+
 // CZerocoinState::CBigNumHash
 
 std::size_t CZerocoinState::CBigNumHash::operator ()(const CBigNum &bn) const noexcept {
@@ -581,7 +641,9 @@ int CZerocoinState::AddMint(CBlockIndex *index, int denomination, const CBigNum
             coinGroup.firstBlock = coinGroup.lastBlock = index;
         }
         else {
-            previousAccValue = coinGroup.lastBlock->accumulatorChanges[make_pair(denomination,mintId)].first;
+            const map<pair<int,int>, pair<CBigNum,int>> &accumulatorChanges = coinGroup.lastBlock->GetPrivacyData().accumulatorChanges;
+            auto accChange = accumulatorChanges.find(make_pair(denomination, mintId));
+            previousAccValue = accChange != accumulatorChanges.end() ? accChange->second.first : CBigNum();
             coinGroup.lastBlock = index;
         }
     }
@@ -606,7 +668,7 @@ void CZerocoinState::AddSpend(const CBigNum &serial) {
 }
 
 void CZerocoinState::AddBlock(CBlockIndex *index) {
-    for(const pair<pair<int,int>, pair<CBigNum,int>> &accUpdate: index->accumulatorChanges)
+    for(const pair<pair<int,int>, pair<CBigNum,int>> &accUpdate: index->GetPrivacyData().accumulatorChanges)
     {
         CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
 
@@ -616,7 +678,7 @@ void CZerocoinState::AddBlock(CBlockIndex *index) {
         coinGroup.nCoins += accUpdate.second.second;
     }
 
-    for(const pair<pair<int,int>,vector<CBigNum>> &pubCoins: index->mintedPubCoins) {
+    for(const pair<pair<int,int>,vector<CBigNum>> &pubCoins: index->GetPrivacyData().mintedPubCoins) {
         latestCoinIds[pubCoins.first.first] = pubCoins.first.second;
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
             CMintedCoinInfo coinInfo;
@@ -626,7 +688,7 @@ void CZerocoinState::AddBlock(CBlockIndex *index) {
             mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(coin, coinInfo));
         }
     }
-    BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
+    BOOST_FOREACH(const CBigNum &serial, index->GetPrivacyData().spentSerials) {
         usedCoinSerials.insert(serial);
     }
 
@@ -634,7 +696,7 @@ void CZerocoinState::AddBlock(CBlockIndex *index) {
 
 void CZerocoinState::RemoveBlock(CBlockIndex *index) {
     // roll back accumulator updates
-    for(const pair<pair<int,int>, pair<CBigNum,int>> &accUpdate: index->accumulatorChanges)
+    for(const pair<pair<int,int>, pair<CBigNum,int>> &accUpdate: index->GetPrivacyData().accumulatorChanges)
     {
         CoinGroupInfo   &coinGroup = coinGroups[accUpdate.first];
         int  nMintsToForget = accUpdate.second.second;
@@ -652,12 +714,12 @@ void CZerocoinState::RemoveBlock(CBlockIndex *index) {
             do {
                 assert(coinGroup.lastBlock != coinGroup.firstBlock);
                 coinGroup.lastBlock = coinGroup.lastBlock->pprev;
-            } while (coinGroup.lastBlock->accumulatorChanges.count(accUpdate.first) == 0);
+            } while (coinGroup.lastBlock->GetPrivacyData().accumulatorChanges.count(accUpdate.first) == 0);
         }
     }
 
     // roll back mints
-    for(const pair<pair<int,int>,vector<CBigNum>> &pubCoins: index->mintedPubCoins) {
+    for(const pair<pair<int,int>,vector<CBigNum>> &pubCoins: index->GetPrivacyData().mintedPubCoins) {
         BOOST_FOREACH(const CBigNum &coin, pubCoins.second) {
             auto coins = mintedPubCoins.equal_range(coin);
             auto coinIt = find_if(coins.first, coins.second, [=](const decltype(mintedPubCoins)::value_type &v) {
@@ -670,7 +732,7 @@ void CZerocoinState::RemoveBlock(CBlockIndex *index) {
     }
 
     // roll back spends
-    BOOST_FOREACH(const CBigNum &serial, index->spentSerials) {
+    BOOST_FOREACH(const CBigNum &serial, index->GetPrivacyData().spentSerials) {
         usedCoinSerials.erase(serial);
     }
 }
@@ -701,25 +763,21 @@ int CZerocoinState::GetAccumulatorValueForSpend(CChain *chain, int maxHeight, in
     CoinGroupInfo coinGroup = coinGroups[denomAndId];
     CBlockIndex *lastBlock = coinGroup.lastBlock;
 
-    assert(lastBlock->accumulatorChanges.count(denomAndId) > 0);
-    assert(coinGroup.firstBlock->accumulatorChanges.count(denomAndId) > 0);
-
-    // field in the block index structure for accesing accumulator changes
-    decltype(&CBlockIndex::accumulatorChanges) accChangeField;
-    accChangeField = &CBlockIndex::accumulatorChanges;
+    assert(lastBlock->GetPrivacyData().accumulatorChanges.count(denomAndId) > 0);
+    assert(coinGroup.firstBlock->GetPrivacyData().accumulatorChanges.count(denomAndId) > 0);
 
     int numberOfCoins = 0;
     for (;;) {
-        map<pair<int,int>, pair<CBigNum,int>> &accumulatorChanges = lastBlock->*accChangeField;
+        const map<pair<int,int>, pair<CBigNum,int>> &accumulatorChanges = lastBlock->GetPrivacyData().accumulatorChanges;
         if (accumulatorChanges.count(denomAndId) > 0) {
             if (lastBlock->nHeight <= maxHeight) {
                 if (numberOfCoins == 0) {
                     // latest block satisfying given conditions
                     // remember accumulator value and block hash
-                    accumulator = accumulatorChanges[denomAndId].first;
+                    accumulator = accumulatorChanges.at(denomAndId).first;
                     blockHash = lastBlock->GetBlockHash();
                 }
-                numberOfCoins += accumulatorChanges[denomAndId].second;
+                numberOfCoins += accumulatorChanges.at(denomAndId).second;
             }
         }
         if (lastBlock == coinGroup.firstBlock)
@@ -751,15 +809,15 @@ libzerocoin::AccumulatorWitness CZerocoinState::GetWitnessForSpend(CChain *chain
     if (block != coinGroup.firstBlock) {
         do {
             block = block->pprev;
-        } while (block->accumulatorChanges.count(denomAndId) == 0);
-        accumulator = libzerocoin::Accumulator(ZCParams, block->accumulatorChanges[denomAndId].first, d);
+        } while (block->GetPrivacyData().accumulatorChanges.count(denomAndId) == 0);
+        accumulator = libzerocoin::Accumulator(ZCParams, block->GetPrivacyData().accumulatorChanges.at(denomAndId).first, d);
     }
 
     // Now add to the accumulator every coin minted since that moment except pubCoin
     block = coinGroup.lastBlock;
     while(true) {
-        if (block->nHeight <= maxHeight && block->mintedPubCoins.count(denomAndId) > 0) {
-            vector<CBigNum> &pubCoins = block->mintedPubCoins[denomAndId];
+        if (block->nHeight <= maxHeight && block->GetPrivacyData().mintedPubCoins.count(denomAndId) > 0) {
+            const vector<CBigNum> &pubCoins = block->GetPrivacyData().mintedPubCoins.at(denomAndId);
             for (const CBigNum &coin: pubCoins) {
                 if (block != mintBlock || coin != pubCoin)
                     accumulator += libzerocoin::PublicCoin(ZCParams, coin, d);
@@ -814,7 +872,7 @@ bool CZerocoinState::GetWitnessForAllSpends(std::vector<CBigNum> &accValues, std
 
             CoinGroupInfo coinGroup = coinGroups[denomAndId];
             CBlockIndex *lastBlock = coinGroup.lastBlock;
-            accValues.push_back(lastBlock->accumulatorChanges[make_pair(denomValue,mintId)].first);
+            accValues.push_back(lastBlock->GetPrivacyData().accumulatorChanges.at(denomAndId).first);
             accBlockHashes.push_back(lastBlock->GetBlockHash());
         }
     }
@@ -849,15 +907,15 @@ CBigNum CZerocoinState::GetWitnessForHeight(int denomination, int mintHeight, in
     if (block != coinGroup.firstBlock) {
         do {
             block = block->pprev;
-        } while (block->accumulatorChanges.count(denomAndId) == 0);
-        accumulator = libzerocoin::Accumulator(ZCParams, block->accumulatorChanges[denomAndId].first, d);
+        } while (block->GetPrivacyData().accumulatorChanges.count(denomAndId) == 0);
+        accumulator = libzerocoin::Accumulator(ZCParams, block->GetPrivacyData().accumulatorChanges.at(denomAndId).first, d);
     }
 
     // Now add to the accumulator every coin minted since that moment except pubCoin
     block = coinGroup.lastBlock;
     while(true) {
-        if (block->nHeight <= maxHeight && block->mintedPubCoins.count(denomAndId) > 0) {
-            vector<CBigNum> &pubCoins = block->mintedPubCoins[denomAndId];
+        if (block->nHeight <= maxHeight && block->GetPrivacyData().mintedPubCoins.count(denomAndId) > 0) {
+            const vector<CBigNum> &pubCoins = block->GetPrivacyData().mintedPubCoins.at(denomAndId);
             for (const CBigNum &coin: pubCoins) {
                 if (block != mintBlock)
                     accumulator += libzerocoin::PublicCoin(ZCParams, coin, d);
@@ -929,22 +987,23 @@ bool CZerocoinState::TestValidity(CChain *chain) {
 
         CBlockIndex *block = coinGroup.second.firstBlock;
         for (;;) {
-            if (block->accumulatorChanges.count(coinGroup.first) > 0) {
-                if (block->mintedPubCoins.count(coinGroup.first) == 0) {
+            const CBlockIndexPrivacyData &privacy = block->GetPrivacyData();
+            if (privacy.accumulatorChanges.count(coinGroup.first) > 0) {
+                if (privacy.mintedPubCoins.count(coinGroup.first) == 0) {
                     fprintf(stderr, "  no minted coins\n");
                     return false;
                 }
 
-                BOOST_FOREACH(const CBigNum &pubCoin, block->mintedPubCoins[coinGroup.first]) {
+                BOOST_FOREACH(const CBigNum &pubCoin, privacy.mintedPubCoins.at(coinGroup.first)) {
                     acc += libzerocoin::PublicCoin(zcParams, pubCoin, (libzerocoin::CoinDenomination)coinGroup.first.first);
                 }
 
-                if (acc.getValue() != block->accumulatorChanges[coinGroup.first].first) {
+                if (acc.getValue() != privacy.accumulatorChanges.at(coinGroup.first).first) {
                     fprintf (stderr, "  accumulator value mismatch at height %d\n", block->nHeight);
                     return false;
                 }
 
-                if (block->accumulatorChanges[coinGroup.first].second != (int)block->mintedPubCoins[coinGroup.first].size()) {
+                if (privacy.accumulatorChanges.at(coinGroup.first).second != (int)privacy.mintedPubCoins.at(coinGroup.first).size()) {
                     fprintf(stderr, "  number of minted coins mismatch at height %d\n", block->nHeight);
                     return false;
                 }
@@ -972,14 +1031,15 @@ set<CBlockIndex *> CZerocoinState::RecalculateAccumulators(CChain *chain) {
         // Try to calculate accumulator for the first batch of mints. If it doesn't match we need to recalculate the rest of it
         CBlockIndex *block = coinGroup.second.firstBlock;
         for (;;) {
-            if (block->accumulatorChanges.count(coinGroup.first) > 0) {
-                BOOST_FOREACH(const CBigNum &pubCoin, block->mintedPubCoins[coinGroup.first]) {
+            if (block->GetPrivacyData().accumulatorChanges.count(coinGroup.first) > 0) {
+                CBlockIndexPrivacyData &privacy = block->PrivacyData();
+                BOOST_FOREACH(const CBigNum &pubCoin, privacy.mintedPubCoins[coinGroup.first]) {
                     acc += libzerocoin::PublicCoin(ZCParams, pubCoin, (libzerocoin::CoinDenomination)coinGroup.first.first);
                 }
 
                 // First block case is special: do the check
                 if (block == coinGroup.second.firstBlock) {
-                    if (acc.getValue() != block->accumulatorChanges[coinGroup.first].first)
+                    if (acc.getValue() != privacy.accumulatorChanges[coinGroup.first].first)
                         // recalculation is needed
                         LogPrintf("ZerocoinState: accumulator recalculation for denomination=%d, id=%d\n", coinGroup.first.first, coinGroup.first.second);
                     else
@@ -987,7 +1047,7 @@ set<CBlockIndex *> CZerocoinState::RecalculateAccumulators(CChain *chain) {
                         break;
                 }
 
-                block->accumulatorChanges[coinGroup.first] = make_pair(acc.getValue(), (int)block->mintedPubCoins[coinGroup.first].size());
+                privacy.accumulatorChanges[coinGroup.first] = make_pair(acc.getValue(), (int)privacy.mintedPubCoins[coinGroup.first].size());
                 changes.insert(block);
             }
 
@@ -1056,6 +1116,68 @@ void CZerocoinState::Reset() {
     mempoolCoinMints.clear();
 }
 
+void CZerocoinState::WriteSnapshot(CDataStream &stream) const {
+    stream << (uint64_t)coinGroups.size();
+    for (const auto &coinGroup : coinGroups) {
+        stream << coinGroup.first;
+        stream << (coinGroup.second.firstBlock ? coinGroup.second.firstBlock->nHeight : -1);
+        stream << (coinGroup.second.lastBlock ? coinGroup.second.lastBlock->nHeight : -1);
+        stream << coinGroup.second.nCoins;
+    }
+
+    stream << (uint64_t)mintedPubCoins.size();
+    for (const auto &coin : mintedPubCoins)
+        stream << coin.first << coin.second.denomination << coin.second.id << coin.second.nHeight;
+
+    stream << latestCoinIds;
+
+    stream << (uint64_t)usedCoinSerials.size();
+    for (const CBigNum &serial : usedCoinSerials)
+        stream << serial;
+}
+
+bool CZerocoinState::ReadSnapshot(CDataStream &stream, CChain *chain) {
+    Reset();
+
+    uint64_t nCoinGroups;
+    stream >> nCoinGroups;
+    while (nCoinGroups--) {
+        pair<int,int> denomAndId;
+        int nFirstHeight, nLastHeight;
+        stream >> denomAndId >> nFirstHeight >> nLastHeight;
+
+        CoinGroupInfo &coinGroup = coinGroups[denomAndId];
+        stream >> coinGroup.nCoins;
+        if (nFirstHeight > chain->Height() || nLastHeight > chain->Height())
+            return false;
+        coinGroup.firstBlock = nFirstHeight < 0 ? NULL : (*chain)[nFirstHeight];
+        coinGroup.lastBlock = nLastHeight < 0 ? NULL : (*chain)[nLastHeight];
+    }
+
+    uint64_t nMintedPubCoins;
+    stream >> nMintedPubCoins;
+    mintedPubCoins.reserve(nMintedPubCoins);
+    while (nMintedPubCoins--) {
+        CBigNum pubCoin;
+        CMintedCoinInfo coinInfo;
+        stream >> pubCoin >> coinInfo.denomination >> coinInfo.id >> coinInfo.nHeight;
+        mintedPubCoins.insert(pair<CBigNum,CMintedCoinInfo>(pubCoin, coinInfo));
+    }
+
+    stream >> latestCoinIds;
+
+    uint64_t nSerials;
+    stream >> nSerials;
+    usedCoinSerials.reserve(nSerials);
+    while (nSerials--) {
+        CBigNum serial;
+        stream >> serial;
+        usedCoinSerials.insert(serial);
+    }
+
+    return true;
+}
+
 CZerocoinState *CZerocoinState::GetZerocoinState() {
     return &zerocoinState;
 }
@@ -21,6 +21,40 @@
 // zerocoin parameters
 extern libzerocoin::Params *ZCParams;
 
+/*
+ * Zerocoin spends of a block waiting for proof verification, checked concurrently on the
+ * compute executor with -zcverifyparallel. Every spend is tried against the accumulator
+ * values of its coin group, newest first, the same way it would have been checked on its own.
+ */
+class CZerocoinSpendBatch {
+public:
+    void Add(std::unique_ptr<libzerocoin::CoinSpend> spend,
+             const libzerocoin::SpendMetaData &metaData,
+             libzerocoin::CoinDenomination denomination,
+             int pubcoinId,
+             const CBlockIndex *lastBlock,
+             const CBlockIndex *firstBlock,
+             bool fHasBlockHash);
+
+    // Verifies and removes all the pending spends, returns false if any of them is invalid
+    bool Verify(int nHeight);
+
+    void Clear() { spends.clear(); }
+
+private:
+    struct CPendingSpend {
+        std::unique_ptr<libzerocoin::CoinSpend> spend;
+        libzerocoin::SpendMetaData metaData;
+        libzerocoin::CoinDenomination denomination;
+        int pubcoinId;
+        const CBlockIndex *lastBlock;
+        const CBlockIndex *firstBlock;
+        bool fHasBlockHash;
+    };
+
+    std::vector<CPendingSpend> spends;
+};
+
 class CZerocoinTxInfo {
 public:
     // all the zerocoin transactions encountered so far
@@ -29,10 +63,14 @@ public:
     vector<pair<int,CBigNum> > mints;
     // serial for every spend
     map<CBigNum, int> spentSerials;
+    // spend proofs are verified, false for blocks buried under the -assumevalid block
+    bool fCheckProofs;
+    // spends of the block waiting for proof verification with -zcverifyparallel
+    CZerocoinSpendBatch spendBatch;
     // information about transactions in the block is complete
     bool fInfoIsComplete;
 
-    CZerocoinTxInfo(): fInfoIsComplete(false) {}
+    CZerocoinTxInfo(): fCheckProofs(true), fInfoIsComplete(false) {}
     // finalize everything
     void Complete();
 };
@@ -137,6 +175,11 @@ public:
     // Reset to initial values
     void Reset();
 
+    // Write the mints and spends of the chain to a startup snapshot, and read them back in place
+    // of the current state. Returns false if the snapshot doesn't fit the chain.
+    void WriteSnapshot(CDataStream &stream) const;
+    bool ReadSnapshot(CDataStream &stream, CChain *chain);
+
     // Test function
     bool TestValidity(CChain *chain);
 